@@ -0,0 +1,287 @@
+#include <benchmark/benchmark.h>
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "lib/circular_buffer.h"
+#include "lib/circular_buffer_ext.h"
+
+namespace {
+
+template <std::size_t N>
+struct Payload {
+    std::array<char, N> bytes{};
+
+    Payload() = default;
+    explicit Payload(std::size_t seed) { bytes[0] = static_cast<char>(seed); }
+
+    std::size_t key() const noexcept {
+        return static_cast<unsigned char>(bytes[0]);
+    }
+};
+
+template <typename T>
+T make_value(std::size_t seed) {
+    if constexpr (std::is_arithmetic_v<T>) {
+        return static_cast<T>(seed);
+    } else {
+        return T(seed);
+    }
+}
+
+template <typename T>
+std::size_t key_of(const T& value) {
+    if constexpr (std::is_arithmetic_v<T>) {
+        return static_cast<std::size_t>(value);
+    } else {
+        return value.key();
+    }
+}
+
+// std::vector used as a fixed-capacity ring with head/size bookkeeping, the
+// usual hand-rolled alternative to a dedicated container.
+template <typename T>
+class VectorRing {
+   public:
+    using value_type = T;
+
+    explicit VectorRing(std::size_t capacity) : data_(capacity) {}
+
+    void push_back(const T& value) {
+        data_[(head_ + size_) % data_.size()] = value;
+        if (size_ == data_.size()) {
+            head_ = (head_ + 1) % data_.size();
+        } else {
+            ++size_;
+        }
+    }
+
+    T pop_front() {
+        T value = data_[head_];
+        head_ = (head_ + 1) % data_.size();
+        --size_;
+        return value;
+    }
+
+    T& operator[](std::size_t i) { return data_[(head_ + i) % data_.size()]; }
+
+    std::size_t size() const noexcept { return size_; }
+
+    template <typename F>
+    void for_each(F f) const {
+        for (std::size_t i = 0; i < size_; ++i) {
+            f(data_[(head_ + i) % data_.size()]);
+        }
+    }
+
+   private:
+    std::vector<T> data_;
+    std::size_t head_ = 0;
+    std::size_t size_ = 0;
+};
+
+template <typename Container>
+Container make_container(std::size_t capacity) {
+    if constexpr (std::is_same_v<Container,
+                                 std::deque<typename Container::value_type>>) {
+        return Container();
+    } else {
+        return Container(capacity);
+    }
+}
+
+template <typename Container>
+using value_of = typename Container::value_type;
+
+template <typename Container>
+void fill(Container& c, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        c.push_back(make_value<value_of<Container>>(i));
+    }
+}
+
+// Leaves exactly n elements with the oldest one away from the start of the
+// storage, so rings are wrapped. Containers that grow instead of
+// overwriting drop the surplus from the front.
+template <typename Container>
+void fill_wrapped(Container& c, std::size_t n) {
+    fill(c, n + n / 2);
+    while (c.size() > n) {
+        c.pop_front();
+    }
+}
+
+template <typename Container>
+void BM_PushPop(benchmark::State& state) {
+    using T = value_of<Container>;
+    const auto capacity = static_cast<std::size_t>(state.range(0));
+    auto c = make_container<Container>(capacity);
+    const T value = make_value<T>(42);
+
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < capacity; ++i) {
+            c.push_back(value);
+        }
+        for (std::size_t i = 0; i < capacity; ++i) {
+            if constexpr (std::is_same_v<Container, std::deque<T>>) {
+                benchmark::DoNotOptimize(c.front());
+                c.pop_front();
+            } else {
+                benchmark::DoNotOptimize(c.pop_front());
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * capacity);
+}
+
+template <typename Container>
+void BM_OverwritePush(benchmark::State& state) {
+    using T = value_of<Container>;
+    const auto capacity = static_cast<std::size_t>(state.range(0));
+    auto c = make_container<Container>(capacity);
+    fill(c, capacity);
+    const T value = make_value<T>(42);
+
+    for (auto _ : state) {
+        if constexpr (std::is_same_v<Container, std::deque<T>>) {
+            c.pop_front();
+        }
+        c.push_back(value);
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename Container>
+void BM_RandomAccess(benchmark::State& state) {
+    const auto capacity = static_cast<std::size_t>(state.range(0));
+    auto c = make_container<Container>(capacity);
+    fill_wrapped(c, capacity);
+
+    std::uint32_t lcg = 12345;
+    const std::size_t n = c.size();
+    for (auto _ : state) {
+        lcg = lcg * 1664525u + 1013904223u;
+        benchmark::DoNotOptimize(c[lcg % n]);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename Container>
+void BM_Iterate(benchmark::State& state) {
+    const auto capacity = static_cast<std::size_t>(state.range(0));
+    auto c = make_container<Container>(capacity);
+    fill_wrapped(c, capacity);
+
+    for (auto _ : state) {
+        std::size_t sum = 0;
+        if constexpr (std::is_same_v<Container,
+                                     VectorRing<value_of<Container>>>) {
+            c.for_each([&sum](const auto& value) { sum += key_of(value); });
+        } else {
+            for (const auto& value : c) {
+                sum += key_of(value);
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * c.size());
+}
+
+template <typename Container>
+void BM_InsertEraseMiddle(benchmark::State& state) {
+    using T = value_of<Container>;
+    const auto capacity = static_cast<std::size_t>(state.range(0));
+    auto c = make_container<Container>(capacity);
+    fill(c, capacity - 1);
+    const T value = make_value<T>(42);
+
+    for (auto _ : state) {
+        auto it = c.insert(c.begin() + c.size() / 2, value);
+        benchmark::DoNotOptimize(it);
+        c.erase(c.begin() + c.size() / 2);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename Container>
+void BM_Growth(benchmark::State& state) {
+    using T = value_of<Container>;
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const T value = make_value<T>(42);
+
+    for (auto _ : state) {
+        Container c;
+        for (std::size_t i = 0; i < n; ++i) {
+            c.push_back(value);
+        }
+        benchmark::DoNotOptimize(c);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+// Copy of a full, wrapped ring followed by clear(): bulk memcpy and O(1)
+// clear for trivially copyable T.
+template <typename Container>
+void BM_CopyClear(benchmark::State& state) {
+    const auto n = static_cast<std::size_t>(state.range(0));
+    auto source = make_container<Container>(n);
+    fill_wrapped(source, n);
+
+    for (auto _ : state) {
+        Container copy(source);
+        benchmark::DoNotOptimize(copy);
+        copy.clear();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+#define CB_BENCHMARK_RING(bench, T)                                  \
+    BENCHMARK_TEMPLATE(bench, CircularBuffer<T>)->Range(64, 1 << 16); \
+    BENCHMARK_TEMPLATE(bench, std::deque<T>)->Range(64, 1 << 16);     \
+    BENCHMARK_TEMPLATE(bench, VectorRing<T>)->Range(64, 1 << 16)
+
+#define CB_BENCHMARK_ALL(bench, T)                                       \
+    BENCHMARK_TEMPLATE(bench, CircularBuffer<T>)->Range(64, 1 << 16);    \
+    BENCHMARK_TEMPLATE(bench, CircularBufferExt<T>)->Range(64, 1 << 16); \
+    BENCHMARK_TEMPLATE(bench, std::deque<T>)->Range(64, 1 << 16)
+
+using Small = std::int32_t;
+using Medium = Payload<64>;
+using Large = Payload<256>;
+
+CB_BENCHMARK_RING(BM_PushPop, Small);
+CB_BENCHMARK_RING(BM_PushPop, Medium);
+CB_BENCHMARK_RING(BM_PushPop, Large);
+BENCHMARK_TEMPLATE(BM_PushPop, CircularBufferExt<Small>)->Range(64, 1 << 16);
+
+CB_BENCHMARK_RING(BM_OverwritePush, Small);
+CB_BENCHMARK_RING(BM_OverwritePush, Medium);
+CB_BENCHMARK_RING(BM_OverwritePush, Large);
+
+CB_BENCHMARK_RING(BM_RandomAccess, Small);
+CB_BENCHMARK_RING(BM_RandomAccess, Medium);
+CB_BENCHMARK_RING(BM_RandomAccess, Large);
+
+CB_BENCHMARK_RING(BM_Iterate, Small);
+CB_BENCHMARK_RING(BM_Iterate, Medium);
+CB_BENCHMARK_RING(BM_Iterate, Large);
+
+CB_BENCHMARK_ALL(BM_InsertEraseMiddle, Small);
+CB_BENCHMARK_ALL(BM_InsertEraseMiddle, Medium);
+
+BENCHMARK_TEMPLATE(BM_Growth, CircularBufferExt<Small>)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_Growth, std::deque<Small>)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_Growth, std::vector<Small>)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_Growth, CircularBufferExt<Medium>)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_Growth, std::deque<Medium>)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_Growth, std::vector<Medium>)->Range(64, 1 << 16);
+
+BENCHMARK_TEMPLATE(BM_CopyClear, CircularBuffer<Small>)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_CopyClear, std::deque<Small>)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_CopyClear, CircularBuffer<Medium>)->Range(64, 1 << 16);
+BENCHMARK_TEMPLATE(BM_CopyClear, std::deque<Medium>)->Range(64, 1 << 16);
+
+}  // namespace
@@ -0,0 +1,443 @@
+// Two-thread latency/throughput harness for queue-like types built on
+// CircularBuffer, plus a many-producer fan-in run. Any type with
+// try_push(const T&) / try_pop(T&) can be plugged into run_suite().
+//
+// Usage: concurrency_benchmarks [--producer-cpu N] [--consumer-cpu N]
+//                               [--messages N] [--round-trips N]
+//                               [--producers N]
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "lib/broadcast_ring.h"
+#include "lib/circular_buffer.h"
+#include "lib/sharded_ring.h"
+#include "lib/staging_buffer.h"
+#include "lib/work_stealing_deque.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    int producer_cpu = -1;
+    int consumer_cpu = -1;
+    std::uint64_t messages = 1'000'000;
+    std::uint64_t round_trips = 100'000;
+    std::size_t capacity = 1024;
+    unsigned producers = 4;
+};
+
+// Log-linear histogram in the spirit of HdrHistogram: values are bucketed
+// by their highest set bit and then by the next kSubBits bits, which keeps
+// the relative error under 1 / 2^kSubBits across the whole range.
+class LatencyHistogram {
+   public:
+    void record(std::uint64_t value) {
+        ++counts_[index(value)];
+        ++total_;
+        max_ = std::max(max_, value);
+        min_ = std::min(min_, value);
+    }
+
+    std::uint64_t percentile(double p) const {
+        const auto target = static_cast<std::uint64_t>(p / 100.0 * total_);
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < counts_.size(); ++i) {
+            seen += counts_[i];
+            if (seen > target) {
+                return std::min(upper_value(i), max_);
+            }
+        }
+        return max_;
+    }
+
+    std::uint64_t max() const noexcept { return max_; }
+
+    std::uint64_t min() const noexcept { return total_ ? min_ : 0; }
+
+   private:
+    static constexpr unsigned kSubBits = 7;
+    static constexpr std::size_t kSubBuckets = std::size_t{1} << kSubBits;
+
+    std::vector<std::uint64_t> counts_ =
+        std::vector<std::uint64_t>((64 - kSubBits + 1) * kSubBuckets);
+    std::uint64_t total_ = 0;
+    std::uint64_t max_ = 0;
+    std::uint64_t min_ = UINT64_MAX;
+
+    static std::size_t index(std::uint64_t value) {
+        if (value < kSubBuckets) {
+            return value;
+        }
+        const unsigned shift = std::bit_width(value) - kSubBits - 1;
+        return (shift + 1) * kSubBuckets + ((value >> shift) - kSubBuckets);
+    }
+
+    static std::uint64_t upper_value(std::size_t i) {
+        if (i < kSubBuckets) {
+            return i;
+        }
+        const std::size_t shift = i / kSubBuckets - 1;
+        const std::uint64_t sub = i % kSubBuckets + kSubBuckets;
+        return ((sub + 1) << shift) - 1;
+    }
+};
+
+void pin_current_thread(int cpu) {
+#if defined(__linux__)
+    if (cpu < 0) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        std::fprintf(stderr, "warning: failed to pin thread to cpu %d\n",
+                     cpu);
+    }
+#else
+    (void)cpu;
+#endif
+}
+
+// Spins briefly before yielding so the harness still makes progress when
+// both threads share one CPU.
+class Backoff {
+   public:
+    void pause() {
+        if (++spins_ > 64) {
+            std::this_thread::yield();
+        }
+    }
+
+    void reset() noexcept { spins_ = 0; }
+
+   private:
+    unsigned spins_ = 0;
+};
+
+template <typename Queue, typename T>
+void push_blocking(Queue& queue, const T& value) {
+    Backoff backoff;
+    while (!queue.try_push(value)) {
+        backoff.pause();
+    }
+}
+
+template <typename Queue, typename T>
+void pop_blocking(Queue& queue, T& value) {
+    Backoff backoff;
+    while (!queue.try_pop(value)) {
+        backoff.pause();
+    }
+}
+
+// Baseline: CircularBuffer guarded by a mutex, rejecting pushes when full
+// instead of overwriting.
+template <typename T>
+class LockedQueue {
+   public:
+    explicit LockedQueue(std::size_t capacity) : buffer_(capacity) {}
+
+    bool try_push(const T& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (buffer_.size() == buffer_.capacity()) {
+            return false;
+        }
+        buffer_.push_back(value);
+        return true;
+    }
+
+    bool try_pop(T& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (buffer_.empty()) {
+            return false;
+        }
+        value = buffer_.pop_front();
+        return true;
+    }
+
+   private:
+    std::mutex mutex_;
+    CircularBuffer<T> buffer_;
+};
+
+template <typename T>
+class BroadcastQueue {
+   public:
+    explicit BroadcastQueue(std::size_t capacity)
+        : ring_(capacity, 1), consumer_(ring_.add_consumer()) {}
+
+    bool try_push(const T& value) { return ring_.try_push(value); }
+
+    bool try_pop(T& value) { return ring_.try_pop(consumer_, value); }
+
+   private:
+    BroadcastRing<T> ring_;
+    std::size_t consumer_;
+};
+
+// A single shard of ShardedRing, i.e. its per-producer SPSC path.
+template <typename T>
+class ShardQueue {
+   public:
+    explicit ShardQueue(std::size_t capacity) : ring_(1, capacity) {}
+
+    bool try_push(const T& value) { return ring_.try_push(0, value); }
+
+    bool try_pop(T& value) {
+        return ring_.poll([&value](T& v) { value = v; }, 1) != 0;
+    }
+
+   private:
+    ShardedRing<T> ring_;
+};
+
+// The producer is the deque's owner and the consumer a thief. The deque
+// grows instead of rejecting, so capacity is only the initial size.
+template <typename T>
+class StealingQueue {
+   public:
+    explicit StealingQueue(std::size_t capacity) : deque_(capacity) {}
+
+    bool try_push(const T& value) {
+        deque_.push(value);
+        return true;
+    }
+
+    bool try_pop(T& value) {
+        auto stolen = deque_.steal();
+        if (!stolen) {
+            return false;
+        }
+        value = *stolen;
+        return true;
+    }
+
+   private:
+    WorkStealingDeque<T> deque_;
+};
+
+template <typename Queue>
+void run_ping_pong(const char* name, const Options& options) {
+    Queue ping(options.capacity);
+    Queue pong(options.capacity);
+    LatencyHistogram histogram;
+
+    std::thread echo([&] {
+        pin_current_thread(options.consumer_cpu);
+        std::uint64_t value = 0;
+        for (std::uint64_t i = 0; i < options.round_trips; ++i) {
+            pop_blocking(ping, value);
+            push_blocking(pong, value);
+        }
+    });
+
+    pin_current_thread(options.producer_cpu);
+    std::uint64_t value = 0;
+    for (std::uint64_t i = 0; i < options.round_trips; ++i) {
+        const auto start = Clock::now();
+        push_blocking(ping, i);
+        pop_blocking(pong, value);
+        const auto rtt = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now() - start);
+        histogram.record(static_cast<std::uint64_t>(rtt.count()));
+    }
+    echo.join();
+
+    std::printf(
+        "%-28s ping-pong rtt ns: min %llu p50 %llu p90 %llu p99 %llu "
+        "p99.9 %llu p99.99 %llu max %llu\n",
+        name, static_cast<unsigned long long>(histogram.min()),
+        static_cast<unsigned long long>(histogram.percentile(50)),
+        static_cast<unsigned long long>(histogram.percentile(90)),
+        static_cast<unsigned long long>(histogram.percentile(99)),
+        static_cast<unsigned long long>(histogram.percentile(99.9)),
+        static_cast<unsigned long long>(histogram.percentile(99.99)),
+        static_cast<unsigned long long>(histogram.max()));
+}
+
+template <typename Queue>
+void run_throughput(const char* name, const Options& options) {
+    Queue queue(options.capacity);
+    std::uint64_t checksum = 0;
+
+    const auto start = Clock::now();
+    std::thread consumer([&] {
+        pin_current_thread(options.consumer_cpu);
+        std::uint64_t value = 0;
+        for (std::uint64_t i = 0; i < options.messages; ++i) {
+            pop_blocking(queue, value);
+            checksum += value;
+        }
+    });
+
+    pin_current_thread(options.producer_cpu);
+    for (std::uint64_t i = 0; i < options.messages; ++i) {
+        push_blocking(queue, i);
+    }
+    consumer.join();
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+
+    const std::uint64_t expected = options.messages * (options.messages - 1) / 2;
+    std::printf("%-28s throughput: %.2f Mmsg/s%s\n", name,
+                options.messages / elapsed.count() / 1e6,
+                checksum == expected ? "" : " (CHECKSUM MISMATCH)");
+}
+
+template <typename Queue>
+void run_suite(const char* name, const Options& options) {
+    run_ping_pong<Queue>(name, options);
+    run_throughput<Queue>(name, options);
+}
+
+// Fan-in throughput: options.producers threads push options.messages
+// elements in total to one consumer, either through one shared locked
+// queue, through StagingBuffers in front of a SharedRing, or through a
+// ShardedRing with a shard per producer. finish(p) runs once producer p is
+// done pushing. Producer p is pinned to CPU producer_cpu + p, wrapped to the
+// number of CPUs, so the producers do not all share one core.
+template <typename Push, typename Finish, typename Poll>
+double fan_in_rate(const Options& options, Push push, Finish finish,
+                   Poll poll) {
+    const std::uint64_t per_producer = options.messages / options.producers;
+    const std::uint64_t total = per_producer * options.producers;
+
+    const int cpus =
+        static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    const auto start = Clock::now();
+    std::vector<std::thread> producers;
+    for (unsigned p = 0; p < options.producers; ++p) {
+        producers.emplace_back([&, p] {
+            if (options.producer_cpu >= 0) {
+                pin_current_thread((options.producer_cpu +
+                                    static_cast<int>(p)) % cpus);
+            }
+            for (std::uint64_t i = 0; i < per_producer; ++i) {
+                push(p, i);
+            }
+            finish(p);
+        });
+    }
+    pin_current_thread(options.consumer_cpu);
+    Backoff backoff;
+    for (std::uint64_t consumed = 0; consumed < total;) {
+        const std::uint64_t n = poll();
+        consumed += n;
+        if (n == 0) {
+            backoff.pause();
+        } else {
+            backoff.reset();
+        }
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    const std::chrono::duration<double> elapsed = Clock::now() - start;
+    return total / elapsed.count() / 1e6;
+}
+
+void run_fan_in(const Options& options) {
+    LockedQueue<std::uint64_t> shared(options.capacity);
+    const double locked = fan_in_rate(
+        options,
+        [&](unsigned, std::uint64_t i) { push_blocking(shared, i); },
+        [](unsigned) {},
+        [&] {
+            std::uint64_t value = 0;
+            return shared.try_pop(value) ? std::uint64_t{1} : 0;
+        });
+
+    SharedRing<std::uint64_t> staged_ring(options.capacity);
+    std::vector<std::unique_ptr<StagingBuffer<std::uint64_t>>> staging;
+    for (unsigned p = 0; p < options.producers; ++p) {
+        staging.push_back(
+            std::make_unique<StagingBuffer<std::uint64_t>>(staged_ring));
+    }
+    const double staged = fan_in_rate(
+        options, [&](unsigned p, std::uint64_t i) { staging[p]->push(i); },
+        [&](unsigned p) { staging[p]->flush(); },
+        [&] {
+            return static_cast<std::uint64_t>(
+                staged_ring.drain([](std::uint64_t&) {}));
+        });
+
+    ShardedRing<std::uint64_t> sharded(options.producers, options.capacity);
+    const double sharded_rate = fan_in_rate(
+        options,
+        [&](unsigned p, std::uint64_t i) {
+            Backoff backoff;
+            while (!sharded.try_push(p, i)) {
+                backoff.pause();
+            }
+        },
+        [](unsigned) {},
+        [&] {
+            return static_cast<std::uint64_t>(
+                sharded.poll([](std::uint64_t&) {}, 64));
+        });
+
+    std::printf("%u-producer fan-in throughput: mutex CircularBuffer "
+                "%.2f Mmsg/s, StagingBuffer %.2f Mmsg/s, ShardedRing "
+                "%.2f Mmsg/s\n",
+                options.producers, locked, staged, sharded_rate);
+}
+
+Options parse_options(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string flag = argv[i];
+        const std::uint64_t value = std::strtoull(argv[i + 1], nullptr, 10);
+        if (flag == "--producer-cpu") {
+            options.producer_cpu = static_cast<int>(value);
+        } else if (flag == "--consumer-cpu") {
+            options.consumer_cpu = static_cast<int>(value);
+        } else if (flag == "--messages") {
+            options.messages = value;
+        } else if (flag == "--round-trips") {
+            options.round_trips = value;
+        } else if (flag == "--capacity") {
+            options.capacity = value;
+        } else if (flag == "--producers") {
+            options.producers = value == 0 ? 1 : static_cast<unsigned>(value);
+        } else {
+            std::fprintf(stderr, "unknown flag %s\n", flag.c_str());
+            std::exit(2);
+        }
+    }
+    return options;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const Options options = parse_options(argc, argv);
+    std::printf("producer cpu %d, consumer cpu %d, capacity %zu\n",
+                options.producer_cpu, options.consumer_cpu, options.capacity);
+
+    run_suite<LockedQueue<std::uint64_t>>("mutex CircularBuffer", options);
+    run_suite<BroadcastQueue<std::uint64_t>>("BroadcastRing (1 consumer)",
+                                             options);
+    run_suite<ShardQueue<std::uint64_t>>("ShardedRing (1 shard)", options);
+    run_suite<StealingQueue<std::uint64_t>>("WorkStealingDeque (steal)",
+                                            options);
+    run_fan_in(options);
+    return 0;
+}
@@ -0,0 +1,265 @@
+#pragma once
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+#include "circular_buffer.h"
+#include "circular_buffer_ext.h"
+
+// Queue of ready coroutines. run() resumes them until the queue is empty
+// and may be called from several threads at once.
+class Executor {
+   public:
+    void schedule(std::coroutine_handle<> handle) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ready_.push_back(handle);
+    }
+
+    void run() {
+        for (;;) {
+            std::coroutine_handle<> handle;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (ready_.empty()) {
+                    return;
+                }
+                handle = ready_.pop_front();
+            }
+            handle.resume();
+        }
+    }
+
+   private:
+    std::mutex mutex_;
+    CircularBufferExt<std::coroutine_handle<>> ready_;
+};
+
+// Fire-and-forget coroutine started by spawn(). The frame destroys itself
+// when the body returns.
+class AsyncTask {
+   public:
+    struct promise_type {
+        AsyncTask get_return_object() noexcept {
+            return AsyncTask(
+                std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        std::suspend_never final_suspend() noexcept { return {}; }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+
+    AsyncTask(AsyncTask&& other) noexcept
+        : handle_(std::exchange(other.handle_, nullptr)) {}
+
+    AsyncTask(const AsyncTask&) = delete;
+    AsyncTask& operator=(const AsyncTask&) = delete;
+
+    ~AsyncTask() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    friend void spawn(Executor& executor, AsyncTask task) {
+        executor.schedule(std::exchange(task.handle_, nullptr));
+    }
+
+   private:
+    std::coroutine_handle<promise_type> handle_;
+
+    explicit AsyncTask(std::coroutine_handle<promise_type> handle) noexcept
+        : handle_(handle) {}
+};
+
+// Bounded channel for coroutines. co_await push(x) suspends while the
+// channel is full and co_await pop() while it is empty; a suspended
+// coroutine is queued inside its own awaiter, so after construction the
+// channel never allocates. Woken coroutines are resumed by the executor.
+template <typename T, typename Alloc = std::allocator<T>>
+class AsyncChannel {
+   public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    class PushAwaiter {
+       public:
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            handle_ = handle;
+            return channel_->suspend_push(*this);
+        }
+
+        // false when the channel was closed before the value went in.
+        bool await_resume() const noexcept { return accepted_; }
+
+       private:
+        friend class AsyncChannel;
+
+        AsyncChannel* channel_;
+        T value_;
+        bool accepted_ = false;
+        std::coroutine_handle<> handle_;
+        PushAwaiter* next_ = nullptr;
+
+        PushAwaiter(AsyncChannel* channel, T value)
+            : channel_(channel), value_(std::move(value)) {}
+    };
+
+    class PopAwaiter {
+       public:
+        bool await_ready() const noexcept { return false; }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            handle_ = handle;
+            return channel_->suspend_pop(*this);
+        }
+
+        // Empty once the channel is closed and drained.
+        std::optional<T> await_resume() { return std::move(value_); }
+
+       private:
+        friend class AsyncChannel;
+
+        AsyncChannel* channel_;
+        std::optional<T> value_;
+        std::coroutine_handle<> handle_;
+        PopAwaiter* next_ = nullptr;
+
+        explicit PopAwaiter(AsyncChannel* channel) : channel_(channel) {}
+    };
+
+    AsyncChannel(size_type capacity, Executor& executor,
+                 const Alloc& allocator = Alloc())
+        : executor_(executor), buffer_(capacity, allocator) {
+        if (capacity == 0) {
+            throw std::invalid_argument("Channel capacity must be > 0");
+        }
+    }
+
+    AsyncChannel(const AsyncChannel&) = delete;
+    AsyncChannel& operator=(const AsyncChannel&) = delete;
+
+    PushAwaiter push(T value) { return PushAwaiter(this, std::move(value)); }
+
+    PopAwaiter pop() { return PopAwaiter(this); }
+
+    // Wakes every waiter: pending pushes report false, pops drain what is
+    // buffered and then return an empty optional.
+    void close() {
+        PushAwaiter* pushers;
+        PopAwaiter* poppers;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+            pushers = std::exchange(pushers_.head, nullptr);
+            poppers = std::exchange(poppers_.head, nullptr);
+            pushers_.tail = nullptr;
+            poppers_.tail = nullptr;
+        }
+        while (pushers != nullptr) {
+            executor_.schedule(std::exchange(pushers, pushers->next_)->handle_);
+        }
+        while (poppers != nullptr) {
+            executor_.schedule(std::exchange(poppers, poppers->next_)->handle_);
+        }
+    }
+
+    size_type size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return buffer_.size();
+    }
+
+    size_type capacity() const noexcept { return buffer_.capacity(); }
+
+   private:
+    // FIFO of suspended awaiters linked through their next_ members.
+    template <typename Awaiter>
+    struct WaiterQueue {
+        Awaiter* head = nullptr;
+        Awaiter* tail = nullptr;
+
+        void push(Awaiter* awaiter) noexcept {
+            awaiter->next_ = nullptr;
+            (tail != nullptr ? tail->next_ : head) = awaiter;
+            tail = awaiter;
+        }
+
+        Awaiter* pop() noexcept {
+            Awaiter* awaiter = head;
+            head = head->next_;
+            if (head == nullptr) {
+                tail = nullptr;
+            }
+            return awaiter;
+        }
+
+        bool empty() const noexcept { return head == nullptr; }
+    };
+
+    Executor& executor_;
+    mutable std::mutex mutex_;
+    CircularBuffer<T, Alloc> buffer_;
+    WaiterQueue<PushAwaiter> pushers_;
+    WaiterQueue<PopAwaiter> poppers_;
+    bool closed_ = false;
+
+    // Both return true when the coroutine has to stay suspended.
+    bool suspend_push(PushAwaiter& awaiter) {
+        std::coroutine_handle<> woken;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (closed_) {
+                return false;
+            }
+            awaiter.accepted_ = true;
+            if (!poppers_.empty()) {
+                PopAwaiter* popper = poppers_.pop();
+                popper->value_.emplace(std::move(awaiter.value_));
+                woken = popper->handle_;
+            } else if (buffer_.size() < buffer_.capacity()) {
+                buffer_.push_back(std::move(awaiter.value_));
+                return false;
+            } else {
+                awaiter.accepted_ = false;
+                pushers_.push(&awaiter);
+                return true;
+            }
+        }
+        executor_.schedule(woken);
+        return false;
+    }
+
+    bool suspend_pop(PopAwaiter& awaiter) {
+        std::coroutine_handle<> woken;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (buffer_.empty()) {
+                if (closed_) {
+                    return false;
+                }
+                poppers_.push(&awaiter);
+                return true;
+            }
+            awaiter.value_.emplace(buffer_.pop_front());
+            if (pushers_.empty()) {
+                return false;
+            }
+            PushAwaiter* pusher = pushers_.pop();
+            buffer_.push_back(std::move(pusher->value_));
+            pusher->accepted_ = true;
+            woken = pusher->handle_;
+        }
+        executor_.schedule(woken);
+        return false;
+    }
+};
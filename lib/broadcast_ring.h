@@ -0,0 +1,221 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+
+// Single-writer ring where every registered consumer sees every element
+// through its own sequence cursor.
+//
+// The policy is a template parameter, so kOverwrite with a T that is not
+// trivially copyable fails to compile.
+//
+// kBlock: the writer waits for the slowest active consumer, consumers read
+// elements in place.
+// kOverwrite: the writer never waits; consumers that fall more than
+// capacity() behind skip ahead and the skipped elements are counted as
+// lost. Reads are seqlock-style copies, so T must be trivially copyable.
+enum class BroadcastPolicy { kBlock, kOverwrite };
+
+template <typename T, BroadcastPolicy Policy = BroadcastPolicy::kBlock,
+          typename Alloc = std::allocator<T>>
+class BroadcastRing {
+    static_assert(Policy == BroadcastPolicy::kBlock ||
+                      std::is_trivially_copyable_v<T>,
+                  "BroadcastPolicy::kOverwrite requires trivially copyable T");
+
+   public:
+    using allocator_type =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+    using allocator_traits =
+        typename std::allocator_traits<Alloc>::template rebind_traits<T>;
+
+    using value_type = T;
+    using const_reference = const T&;
+    using pointer = T*;
+    using size_type = std::size_t;
+    using sequence_type = std::uint64_t;
+
+    BroadcastRing(size_type capacity, size_type max_consumers,
+                  const Alloc& allocator = Alloc())
+        : allocator_(allocator),
+          capacity_(capacity),
+          max_consumers_(max_consumers),
+          slots_(allocator_traits::allocate(allocator_, capacity)),
+          consumers_(new Consumer[max_consumers]) {
+        if (capacity == 0) {
+            allocator_traits::deallocate(allocator_, slots_, capacity_);
+            throw std::invalid_argument("BroadcastRing capacity must be > 0");
+        }
+    }
+
+    BroadcastRing(const BroadcastRing&) = delete;
+    BroadcastRing& operator=(const BroadcastRing&) = delete;
+
+    ~BroadcastRing() {
+        const sequence_type published = published_.load();
+        const sequence_type first =
+            published > capacity_ ? published - capacity_ : 0;
+        for (sequence_type seq = first; seq != published; ++seq) {
+            allocator_traits::destroy(allocator_, slot(seq));
+        }
+        allocator_traits::deallocate(allocator_, slots_, capacity_);
+    }
+
+    // Registers a consumer that starts with the next published element.
+    size_type add_consumer() {
+        for (size_type id = 0; id < max_consumers_; ++id) {
+            bool expected = false;
+            if (consumers_[id].active.compare_exchange_strong(expected,
+                                                              true)) {
+                consumers_[id].cursor.store(published_.load(),
+                                            std::memory_order_release);
+                consumers_[id].lost = 0;
+                return id;
+            }
+        }
+        throw std::length_error("Too many BroadcastRing consumers");
+    }
+
+    void remove_consumer(size_type id) {
+        consumers_[id].active.store(false, std::memory_order_release);
+    }
+
+    void push(const T& value) {
+        while (!try_push(value)) {
+            std::this_thread::yield();
+        }
+    }
+
+    bool try_push(const T& value) {
+        const sequence_type seq = published_.load(std::memory_order_relaxed);
+
+        if constexpr (Policy == BroadcastPolicy::kBlock) {
+            if (seq >= capacity_ && seq - gating_ >= capacity_) {
+                gating_ = slowest_consumer(seq);
+                if (seq - gating_ >= capacity_) {
+                    return false;
+                }
+            }
+        } else {
+            claimed_.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+
+        if (seq >= capacity_) {
+            *slot(seq) = value;
+        } else {
+            allocator_traits::construct(allocator_, slot(seq), value);
+        }
+        published_.store(seq + 1, std::memory_order_release);
+        return true;
+    }
+
+    // kBlock only: calls f(const T&) on the consumer's next element in place.
+    template <typename F>
+    bool try_consume(size_type id, F&& f)
+        requires(Policy == BroadcastPolicy::kBlock)
+    {
+        Consumer& consumer = consumers_[id];
+        const sequence_type seq =
+            consumer.cursor.load(std::memory_order_relaxed);
+        if (seq == published_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        f(static_cast<const_reference>(*slot(seq)));
+        consumer.cursor.store(seq + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(size_type id, T& out) {
+        if constexpr (Policy == BroadcastPolicy::kOverwrite) {
+            return try_pop_overwritten(id, out);
+        } else {
+            return try_consume(id,
+                               [&out](const_reference value) { out = value; });
+        }
+    }
+
+    sequence_type published() const noexcept {
+        return published_.load(std::memory_order_acquire);
+    }
+
+    // Elements consumer id has skipped because it fell behind (kOverwrite).
+    sequence_type lost(size_type id) const noexcept {
+        return consumers_[id].lost;
+    }
+
+    size_type capacity() const noexcept { return capacity_; }
+
+    static constexpr BroadcastPolicy policy() noexcept { return Policy; }
+
+   private:
+    struct alignas(64) Consumer {
+        std::atomic<sequence_type> cursor{0};
+        std::atomic<bool> active{false};
+        sequence_type lost = 0;
+    };
+
+    allocator_type allocator_;
+    size_type capacity_;
+    size_type max_consumers_;
+    pointer slots_;
+    std::unique_ptr<Consumer[]> consumers_;
+
+    alignas(64) std::atomic<sequence_type> published_{0};
+    std::atomic<sequence_type> claimed_{0};
+    sequence_type gating_ = 0;
+
+    pointer slot(sequence_type seq) const noexcept {
+        return slots_ + seq % capacity_;
+    }
+
+    sequence_type slowest_consumer(sequence_type seq) const noexcept {
+        sequence_type slowest = seq;
+        for (size_type id = 0; id < max_consumers_; ++id) {
+            if (!consumers_[id].active.load(std::memory_order_acquire)) {
+                continue;
+            }
+            const sequence_type cursor =
+                consumers_[id].cursor.load(std::memory_order_acquire);
+            slowest = cursor < slowest ? cursor : slowest;
+        }
+        return slowest;
+    }
+
+    bool try_pop_overwritten(size_type id, T& out) {
+        Consumer& consumer = consumers_[id];
+        sequence_type seq = consumer.cursor.load(std::memory_order_relaxed);
+
+        while (true) {
+            const sequence_type published =
+                published_.load(std::memory_order_acquire);
+            if (seq == published) {
+                return false;
+            }
+            if (published - seq > capacity_) {
+                consumer.lost += published - capacity_ - seq;
+                seq = published - capacity_;
+            }
+
+            alignas(T) unsigned char copy[sizeof(T)];
+            std::memcpy(copy, slot(seq), sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            const sequence_type claimed =
+                claimed_.load(std::memory_order_relaxed);
+            if (claimed - seq > capacity_) {
+                consumer.lost += claimed - capacity_ - seq;
+                seq = claimed - capacity_;
+                continue;
+            }
+
+            std::memcpy(std::addressof(out), copy, sizeof(T));
+            consumer.cursor.store(seq + 1, std::memory_order_release);
+            return true;
+        }
+    }
+};
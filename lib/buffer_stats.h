@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+struct BufferStatsSnapshot {
+    std::uint64_t overwrites = 0;
+    std::uint64_t growths = 0;
+    std::uint64_t high_water_mark = 0;
+    std::uint64_t bytes_moved = 0;
+};
+
+// Default stats policy: every hook is empty and the member takes no space,
+// so instrumentation compiles away entirely.
+struct NoBufferStats {
+    static constexpr bool kEnabled = false;
+
+    void on_overwrite() noexcept {}
+    void on_growth() noexcept {}
+    void on_size(std::uint64_t) noexcept {}
+    void on_bytes_moved(std::uint64_t) noexcept {}
+
+    BufferStatsSnapshot snapshot() const noexcept { return {}; }
+    void reset() noexcept {}
+};
+
+// Counts overwrites, growths, peak occupancy and bytes moved by reserve().
+// Counters are relaxed atomics so a monitoring thread can read snapshot()
+// while the owning thread keeps pushing.
+class BufferStats {
+   public:
+    static constexpr bool kEnabled = true;
+
+    BufferStats() noexcept = default;
+
+    // A copied buffer starts with its own, empty history.
+    BufferStats(const BufferStats&) noexcept {}
+
+    BufferStats& operator=(const BufferStats&) noexcept { return *this; }
+
+    void on_overwrite() noexcept {
+        overwrites_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void on_growth() noexcept {
+        growths_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void on_size(std::uint64_t size) noexcept {
+        if (size > high_water_mark_.load(std::memory_order_relaxed)) {
+            high_water_mark_.store(size, std::memory_order_relaxed);
+        }
+    }
+
+    void on_bytes_moved(std::uint64_t bytes) noexcept {
+        bytes_moved_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    BufferStatsSnapshot snapshot() const noexcept {
+        return {overwrites_.load(std::memory_order_relaxed),
+                growths_.load(std::memory_order_relaxed),
+                high_water_mark_.load(std::memory_order_relaxed),
+                bytes_moved_.load(std::memory_order_relaxed)};
+    }
+
+    void reset() noexcept {
+        overwrites_.store(0, std::memory_order_relaxed);
+        growths_.store(0, std::memory_order_relaxed);
+        high_water_mark_.store(0, std::memory_order_relaxed);
+        bytes_moved_.store(0, std::memory_order_relaxed);
+    }
+
+   private:
+    std::atomic<std::uint64_t> overwrites_{0};
+    std::atomic<std::uint64_t> growths_{0};
+    std::atomic<std::uint64_t> high_water_mark_{0};
+    std::atomic<std::uint64_t> bytes_moved_{0};
+};
@@ -2,79 +2,97 @@
 #include "circular_buffer_common.h"
 #include "iterator/random_access_iterator.h"
 
-template <typename T, typename Alloc = std::allocator<T>>
-class CircularBuffer : protected CircularBufferCommon<T, Alloc> {
+template <typename T, typename Alloc = std::allocator<T>,
+          typename Stats = NoBufferStats>
+class CircularBuffer : protected CircularBufferCommon<T, Alloc, Stats> {
    public:
-    using typename CircularBufferCommon<T, Alloc>::allocator_type;
-    using typename CircularBufferCommon<T, Alloc>::allocator_traits;
+    using typename CircularBufferCommon<T, Alloc, Stats>::allocator_type;
+    using typename CircularBufferCommon<T, Alloc, Stats>::allocator_traits;
 
-    using typename CircularBufferCommon<T, Alloc>::iterator;
-    using typename CircularBufferCommon<T, Alloc>::const_iterator;
+    using typename CircularBufferCommon<T, Alloc, Stats>::iterator;
+    using typename CircularBufferCommon<T, Alloc, Stats>::const_iterator;
 
-    using typename CircularBufferCommon<T, Alloc>::value_type;
-    using typename CircularBufferCommon<T, Alloc>::reference;
-    using typename CircularBufferCommon<T, Alloc>::pointer;
-    using typename CircularBufferCommon<T, Alloc>::const_reference;
-    using typename CircularBufferCommon<T, Alloc>::difference_type;
-    using typename CircularBufferCommon<T, Alloc>::size_type;
+    using typename CircularBufferCommon<T, Alloc, Stats>::value_type;
+    using typename CircularBufferCommon<T, Alloc, Stats>::reference;
+    using typename CircularBufferCommon<T, Alloc, Stats>::pointer;
+    using typename CircularBufferCommon<T, Alloc, Stats>::const_reference;
+    using typename CircularBufferCommon<T, Alloc, Stats>::difference_type;
+    using typename CircularBufferCommon<T, Alloc, Stats>::size_type;
+    using typename CircularBufferCommon<T, Alloc, Stats>::stats_type;
 
     explicit CircularBuffer(const Alloc& allocator = Alloc())
-        : CircularBufferCommon<T, Alloc>(allocator) {}
+        : CircularBufferCommon<T, Alloc, Stats>(allocator) {}
 
     explicit CircularBuffer(size_type n, const Alloc& allocator = Alloc())
-        : CircularBufferCommon<T, Alloc>(n, allocator) {}
+        : CircularBufferCommon<T, Alloc, Stats>(n, allocator) {}
 
     CircularBuffer(size_type n, value_type value,
                    const Alloc& allocator = Alloc())
-        : CircularBufferCommon<T, Alloc>(n, value, allocator) {}
+        : CircularBufferCommon<T, Alloc, Stats>(n, value, allocator) {}
 
-    CircularBuffer(const CircularBuffer<T, Alloc>& other)
-        : CircularBufferCommon<T, Alloc>(other) {}
+    CircularBuffer(const CircularBuffer<T, Alloc, Stats>& other)
+        : CircularBufferCommon<T, Alloc, Stats>(other) {}
 
     template <typename LegacyInputIterator>
     CircularBuffer(LegacyInputIterator i, LegacyInputIterator j,
                    const Alloc& allocator = Alloc())
-        : CircularBufferCommon<T, Alloc>(i, j, allocator) {}
+        : CircularBufferCommon<T, Alloc, Stats>(i, j, allocator) {}
 
     CircularBuffer(const std::initializer_list<value_type>& list,
                    const Alloc& allocator = Alloc())
-        : CircularBufferCommon<T, Alloc>(list, allocator) {}
+        : CircularBufferCommon<T, Alloc, Stats>(list, allocator) {}
+
+    CircularBuffer(CircularBuffer&& other) = default;
 
     ~CircularBuffer() {
         clear();
-        allocator_traits::deallocate(allocator_, container_begin_,
-                                     capacity() + 1);
+        deallocate_slots(container_begin_, capacity() + 1);
     }
 
     CircularBuffer& operator=(const CircularBuffer& other) {
-        static_cast<CircularBufferCommon<T, Alloc>&>(*this).operator=(
-            static_cast<CircularBufferCommon<T, Alloc>&>(other));
+        CircularBufferCommon<T, Alloc, Stats>::operator=(other);
         return *this;
     }
 
-    using CircularBufferCommon<T, Alloc>::begin;
-    using CircularBufferCommon<T, Alloc>::end;
-    using CircularBufferCommon<T, Alloc>::cbegin;
-    using CircularBufferCommon<T, Alloc>::cend;
-    using CircularBufferCommon<T, Alloc>::swap;
-    using CircularBufferCommon<T, Alloc>::size;
-    using CircularBufferCommon<T, Alloc>::capacity;
-    using CircularBufferCommon<T, Alloc>::max_size;
-    using CircularBufferCommon<T, Alloc>::empty;
-    using CircularBufferCommon<T, Alloc>::reserve;
-    using CircularBufferCommon<T, Alloc>::resize;
-    using CircularBufferCommon<T, Alloc>::erase;
-    using CircularBufferCommon<T, Alloc>::clear;
-    using CircularBufferCommon<T, Alloc>::assign;
-    using CircularBufferCommon<T, Alloc>::pop_back;
-    using CircularBufferCommon<T, Alloc>::pop_front;
-    using CircularBufferCommon<T, Alloc>::front;
-    using CircularBufferCommon<T, Alloc>::back;
-    using CircularBufferCommon<T, Alloc>::at;
+    CircularBuffer& operator=(CircularBuffer&& other) = default;
+
+    using CircularBufferCommon<T, Alloc, Stats>::begin;
+    using CircularBufferCommon<T, Alloc, Stats>::end;
+    using CircularBufferCommon<T, Alloc, Stats>::cbegin;
+    using CircularBufferCommon<T, Alloc, Stats>::cend;
+    using CircularBufferCommon<T, Alloc, Stats>::nth;
+    using CircularBufferCommon<T, Alloc, Stats>::swap;
+    using CircularBufferCommon<T, Alloc, Stats>::size;
+    using CircularBufferCommon<T, Alloc, Stats>::capacity;
+    using CircularBufferCommon<T, Alloc, Stats>::max_size;
+    using CircularBufferCommon<T, Alloc, Stats>::empty;
+    using CircularBufferCommon<T, Alloc, Stats>::reserve;
+    using CircularBufferCommon<T, Alloc, Stats>::resize;
+    using CircularBufferCommon<T, Alloc, Stats>::erase;
+    using CircularBufferCommon<T, Alloc, Stats>::clear;
+    using CircularBufferCommon<T, Alloc, Stats>::assign;
+    using CircularBufferCommon<T, Alloc, Stats>::pop_back;
+    using CircularBufferCommon<T, Alloc, Stats>::pop_front;
+    using CircularBufferCommon<T, Alloc, Stats>::front;
+    using CircularBufferCommon<T, Alloc, Stats>::back;
+    using CircularBufferCommon<T, Alloc, Stats>::at;
+    using CircularBufferCommon<T, Alloc, Stats>::operator[];
+    using CircularBufferCommon<T, Alloc, Stats>::first_segment;
+    using CircularBufferCommon<T, Alloc, Stats>::second_segment;
+    using CircularBufferCommon<T, Alloc, Stats>::is_linearized;
+    using CircularBufferCommon<T, Alloc, Stats>::linearize;
+    using CircularBufferCommon<T, Alloc, Stats>::prepare;
+    using CircularBufferCommon<T, Alloc, Stats>::commit;
+    using CircularBufferCommon<T, Alloc, Stats>::peek;
+    using CircularBufferCommon<T, Alloc, Stats>::release;
+    using CircularBufferCommon<T, Alloc, Stats>::stats;
+    using CircularBufferCommon<T, Alloc, Stats>::reset_stats;
+    using CircularBufferCommon<T, Alloc, Stats>::serialize;
+    using CircularBufferCommon<T, Alloc, Stats>::deserialize;
 
     void swap(CircularBuffer& other) {
-        static_cast<CircularBufferCommon<T, Alloc>&>(*this).swap(
-            static_cast<CircularBufferCommon<T, Alloc>&>(other));
+        static_cast<CircularBufferCommon<T, Alloc, Stats>&>(*this).swap(
+            static_cast<CircularBufferCommon<T, Alloc, Stats>&>(other));
     }
 
     void push_back(const T& value) {
@@ -91,6 +109,7 @@ class CircularBuffer : protected CircularBufferCommon<T, Alloc> {
 
         if (next == data_begin_) {
             allocator_traits::destroy(allocator_, data_begin_);
+            stats_.on_overwrite();
 
             if (data_begin_ + 1 == container_end_) {
                 data_begin_ = container_begin_;
@@ -104,6 +123,7 @@ class CircularBuffer : protected CircularBufferCommon<T, Alloc> {
         } else {
             ++data_end_;
         }
+        record_size();
     }
 
     void push_front(const T& value) {
@@ -125,8 +145,10 @@ class CircularBuffer : protected CircularBufferCommon<T, Alloc> {
             }
 
             allocator_traits::destroy(allocator_, data_end_);
+            stats_.on_overwrite();
         }
         data_begin_ = new_data_begin;
+        record_size();
     }
 
     iterator insert(const_iterator p, const_reference value) {
@@ -164,6 +186,7 @@ class CircularBuffer : protected CircularBufferCommon<T, Alloc> {
             *last = std::move_if_noexcept(*(last - 1));
         }
         *it = value;
+        record_size();
         return it;
     }
 
@@ -210,6 +233,7 @@ class CircularBuffer : protected CircularBufferCommon<T, Alloc> {
                                         std::addressof(to_insert[i]), value);
         }
 
+        record_size();
         return to_insert;
     }
 
@@ -265,6 +289,7 @@ class CircularBuffer : protected CircularBufferCommon<T, Alloc> {
                                         std::addressof(to_insert[k]), *i);
         }
 
+        record_size();
         return to_insert;
     }
 
@@ -274,28 +299,32 @@ class CircularBuffer : protected CircularBufferCommon<T, Alloc> {
     }
 
     bool operator==(const CircularBuffer& other) const noexcept {
-        return static_cast<const CircularBufferCommon<T, Alloc>&>(*this).
-        operator==(static_cast<const CircularBufferCommon<T, Alloc>&>(other));
+        return static_cast<const CircularBufferCommon<T, Alloc, Stats>&>(*this)
+            .operator==(
+                static_cast<const CircularBufferCommon<T, Alloc, Stats>&>(
+                    other));
     }
 
     bool operator!=(const CircularBuffer& other) const noexcept {
-        return static_cast<const CircularBufferCommon<T, Alloc>&>(*this).
-        operator!=(static_cast<const CircularBufferCommon<T, Alloc>&>(other));
+        return static_cast<const CircularBufferCommon<T, Alloc, Stats>&>(*this)
+            .operator!=(
+                static_cast<const CircularBufferCommon<T, Alloc, Stats>&>(
+                    other));
     }
 
-    reference operator[](size_type i) { return *(begin() + i); }
-
-    const_reference operator[](size_type i) const { return *(cbegin() + i); }
-
    private:
-    using CircularBufferCommon<T, Alloc>::container_begin_;
-    using CircularBufferCommon<T, Alloc>::container_end_;
-    using CircularBufferCommon<T, Alloc>::data_begin_;
-    using CircularBufferCommon<T, Alloc>::data_end_;
-    using CircularBufferCommon<T, Alloc>::allocator_;
+    using CircularBufferCommon<T, Alloc, Stats>::container_begin_;
+    using CircularBufferCommon<T, Alloc, Stats>::container_end_;
+    using CircularBufferCommon<T, Alloc, Stats>::data_begin_;
+    using CircularBufferCommon<T, Alloc, Stats>::data_end_;
+    using CircularBufferCommon<T, Alloc, Stats>::allocator_;
+    using CircularBufferCommon<T, Alloc, Stats>::stats_;
+    using CircularBufferCommon<T, Alloc, Stats>::record_size;
+    using CircularBufferCommon<T, Alloc, Stats>::deallocate_slots;
 };
 
-template <typename T, typename Alloc>
-void swap(CircularBuffer<T, Alloc>& lhs, CircularBuffer<T, Alloc>& rhs) {
+template <typename T, typename Alloc, typename Stats>
+void swap(CircularBuffer<T, Alloc, Stats>& lhs,
+          CircularBuffer<T, Alloc, Stats>& rhs) {
     lhs.swap(rhs);
 }
\ No newline at end of file
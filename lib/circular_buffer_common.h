@@ -1,10 +1,36 @@
 #pragma once
 
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "buffer_stats.h"
 #include "iterator/random_access_iterator.h"
+#include "snapshot_io.h"
+
+// True when [start, end) can be copied into uninitialized T storage with a
+// single memcpy instead of per-element allocator_traits::construct calls.
+template <typename InputIterator, typename T, typename Alloc>
+constexpr bool kBulkCopyable =
+    std::contiguous_iterator<InputIterator> &&
+    std::is_same_v<std::iter_value_t<InputIterator>, T> &&
+    std::is_trivially_copyable_v<T> && std::is_same_v<Alloc, std::allocator<T>>;
 
 template <typename InputIterator, typename T, typename Alloc>
 void copy_data(InputIterator start, InputIterator end, T* out,
                Alloc& allocator) {
+    if constexpr (kBulkCopyable<InputIterator, T, Alloc>) {
+        if (start != end) {
+            std::memcpy(out, std::to_address(start),
+                        (end - start) * sizeof(T));
+        }
+        return;
+    }
     auto current = out;
     try {
         for (; start != end; ++start, ++current) {
@@ -21,6 +47,10 @@ void copy_data(InputIterator start, InputIterator end, T* out,
 template <typename InputIterator, typename T, typename Alloc>
 void move_data(InputIterator start, InputIterator end, T* out,
                Alloc& allocator) {
+    if constexpr (kBulkCopyable<InputIterator, T, Alloc>) {
+        copy_data(start, end, out, allocator);
+        return;
+    }
     auto current = out;
     try {
         for (; start != end; ++start, ++current) {
@@ -35,7 +65,30 @@ void move_data(InputIterator start, InputIterator end, T* out,
     }
 }
 
-template <typename T, typename Alloc = std::allocator<T>>
+// Uninitialized room for InlineCapacity elements plus the sentinel slot,
+// embedded in the buffer object itself.
+template <typename T, std::size_t InlineCapacity>
+struct InlineStorage {
+    alignas(T) unsigned char bytes[(InlineCapacity + 1) * sizeof(T)];
+
+    T* data() noexcept { return reinterpret_cast<T*>(bytes); }
+
+    const T* data() const noexcept {
+        return reinterpret_cast<const T*>(bytes);
+    }
+};
+
+// Without inline elements a zero-capacity buffer still needs its sentinel
+// slot. It is never constructed into, so one per type is shared.
+template <typename T>
+struct InlineStorage<T, 0> {
+    alignas(T) static inline unsigned char sentinel[sizeof(T)];
+
+    T* data() const noexcept { return reinterpret_cast<T*>(sentinel); }
+};
+
+template <typename T, typename Alloc = std::allocator<T>,
+          typename Stats = NoBufferStats, std::size_t InlineCapacity = 0>
 class CircularBufferCommon
     : protected std::allocator_traits<Alloc>::template rebind_alloc<T> {
    public:
@@ -54,6 +107,7 @@ class CircularBufferCommon
 
     using difference_type = iterator::difference_type;
     using size_type = std::size_t;
+    using stats_type = Stats;
 
     static_assert(std::random_access_iterator<iterator>,
                   "my iterator isn't random access iterator");
@@ -62,8 +116,13 @@ class CircularBufferCommon
         if (this == &other) {
             return;
         }
-        if constexpr (allocator_traits::propagate_on_container_swap::value) {
-            std::swap(this->allocator_, other.allocator_);
+        constexpr bool propagate =
+            allocator_traits::propagate_on_container_swap::value;
+        if ((propagate || allocator_ == other.allocator_) && !is_inline() &&
+            !other.is_inline()) {
+            if constexpr (propagate) {
+                std::swap(this->allocator_, other.allocator_);
+            }
             std::swap(container_begin_, other.container_begin_);
             std::swap(container_end_, other.container_end_);
             std::swap(data_begin_, other.data_begin_);
@@ -77,15 +136,16 @@ class CircularBufferCommon
         const size_type other_old_size = other.size();
         const size_type other_old_capacity = other.capacity();
 
+        size_type this_slots = other_old_capacity + 1;
+        size_type other_slots = this_old_capacity + 1;
         pointer new_this_container_begin =
-            allocator_traits::allocate(allocator_, other_old_capacity + 1);
+            allocate_slots(this_slots, container_begin_);
         pointer new_other_container_begin;
         try {
             new_other_container_begin =
-                allocator_traits::allocate(other.allocator_, this_old_size + 1);
+                other.allocate_slots(other_slots, other.container_begin_);
         } catch (...) {
-            allocator_traits::deallocate(allocator_, new_this_container_begin,
-                                         other_old_capacity + 1);
+            deallocate_slots(new_this_container_begin, this_slots);
             throw;
         }
 
@@ -95,30 +155,23 @@ class CircularBufferCommon
             move_data(other.begin(), other.end(), new_this_container_begin,
                       this->allocator_);
         } catch (...) {
-            allocator_traits::deallocate(allocator_, new_this_container_begin,
-                                         other_old_capacity + 1);
-            allocator_traits::deallocate(other.allocator_,
-                                         new_other_container_begin,
-                                         this_old_capacity + 1);
+            deallocate_slots(new_this_container_begin, this_slots);
+            other.deallocate_slots(new_other_container_begin, other_slots);
             throw;
         }
 
         clear();
         other.clear();
-        allocator_traits::deallocate(allocator_, this->container_begin_,
-                                     this_old_capacity + 1);
-        allocator_traits::deallocate(other.allocator_, other.container_begin_,
-                                     other_old_capacity + 1);
+        deallocate_slots(this->container_begin_, this_old_capacity + 1);
+        other.deallocate_slots(other.container_begin_, other_old_capacity + 1);
 
         this->container_begin_ = new_this_container_begin;
-        this->container_end_ =
-            new_this_container_begin + other_old_capacity + 1;
+        this->container_end_ = new_this_container_begin + this_slots;
         this->data_begin_ = this->container_begin_;
         this->data_end_ = this->data_begin_ + other_old_size;
 
         other.container_begin_ = new_other_container_begin;
-        other.container_end_ =
-            new_other_container_begin + this_old_capacity + 1;
+        other.container_end_ = new_other_container_begin + other_slots;
         other.data_begin_ = other.container_begin_;
         other.data_end_ = other.data_begin_ + this_old_size;
     }
@@ -152,6 +205,144 @@ class CircularBufferCommon
                               data_begin_, data_end_);
     }
 
+    // Iterator to the i-th element (end() for i == size()), computed from
+    // the index directly rather than by stepping an iterator.
+    iterator nth(size_type i) noexcept {
+        return iterator(element_slot(i), container_begin_, container_end_,
+                        data_begin_, data_end_);
+    }
+
+    const_iterator nth(size_type i) const noexcept {
+        return const_iterator(element_slot(i), container_begin_,
+                              container_end_, data_begin_, data_end_);
+    }
+
+    BufferStatsSnapshot stats() const noexcept { return stats_.snapshot(); }
+
+    void reset_stats() noexcept { stats_.reset(); }
+
+    std::span<T> first_segment() noexcept {
+        if (data_begin_ <= data_end_) {
+            return std::span<T>(data_begin_, data_end_);
+        }
+        return std::span<T>(data_begin_, container_end_);
+    }
+
+    std::span<T> second_segment() noexcept {
+        if (data_begin_ <= data_end_) {
+            return std::span<T>();
+        }
+        return std::span<T>(container_begin_, data_end_);
+    }
+
+    std::span<const T> first_segment() const noexcept {
+        if (data_begin_ <= data_end_) {
+            return std::span<const T>(data_begin_, data_end_);
+        }
+        return std::span<const T>(data_begin_, container_end_);
+    }
+
+    std::span<const T> second_segment() const noexcept {
+        if (data_begin_ <= data_end_) {
+            return std::span<const T>();
+        }
+        return std::span<const T>(container_begin_, data_end_);
+    }
+
+    bool is_linearized() const noexcept { return second_segment().empty(); }
+
+    // Rotates the storage in place so that the elements start at the
+    // beginning of it and returns them as one span. Trivially copyable
+    // elements are shifted with memmove through a copy of the shorter
+    // segment; otherwise every element is moved once along the cycles of
+    // the rotation, entering each cycle at a free slot when it has one.
+    // Types whose move may throw are copied into new storage instead.
+    std::span<T> linearize() {
+        if (is_linearized()) {
+            return first_segment();
+        }
+        const size_type n = size();
+        if constexpr (kBulkCopy) {
+            rotate_segments();
+        } else if constexpr (std::is_nothrow_move_constructible_v<T>) {
+            rotate_cycles();
+        } else {
+            size_type slots = capacity() + 1;
+            pointer new_container_begin =
+                allocator_traits::allocate(allocator_, slots);
+            try {
+                copy_data(cbegin(), cend(), new_container_begin, allocator_);
+            } catch (...) {
+                allocator_traits::deallocate(allocator_, new_container_begin,
+                                             slots);
+                throw;
+            }
+            clear();
+            deallocate_slots(container_begin_, slots);
+            container_begin_ = new_container_begin;
+            container_end_ = container_begin_ + slots;
+        }
+        data_begin_ = container_begin_;
+        data_end_ = container_begin_ + n;
+        stats_.on_bytes_moved(n * sizeof(T));
+        return std::span<T>(data_begin_, n);
+    }
+
+    // Two-phase write: prepare(n) exposes the next n free slots (split in
+    // two where they wrap) for the caller to fill in place, and commit(k)
+    // appends the first k of them. Slots are raw storage that commit() turns
+    // into elements without a construct call, hence the kBulkCopy bound.
+    std::pair<std::span<T>, std::span<T>> prepare(size_type n)
+        requires kBulkCopy
+    {
+        if (n > capacity() - size()) {
+            throw std::out_of_range("Not enough free slots to prepare");
+        }
+        return region(data_end_, n);
+    }
+
+    void commit(size_type k)
+        requires kBulkCopy
+    {
+        if (k > capacity() - size()) {
+            throw std::out_of_range("Committing more than the free slots");
+        }
+        data_end_ = advance(data_end_, k);
+        record_size();
+    }
+
+    // Two-phase read: peek(n) exposes the first n elements in place and
+    // release(k) removes the first k of them.
+    std::pair<std::span<T>, std::span<T>> peek(size_type n) {
+        if (n > size()) {
+            throw std::out_of_range("Peeking past the end of the buffer");
+        }
+        return region(data_begin_, n);
+    }
+
+    std::pair<std::span<const T>, std::span<const T>> peek(
+        size_type n) const {
+        if (n > size()) {
+            throw std::out_of_range("Peeking past the end of the buffer");
+        }
+        const auto [first, second] = region(data_begin_, n);
+        return {first, second};
+    }
+
+    void release(size_type k) {
+        if (k > size()) {
+            throw std::out_of_range("Releasing more elements than stored");
+        }
+        if constexpr (kTrivialDestroy) {
+            data_begin_ = advance(data_begin_, k);
+        } else {
+            for (; k > 0; --k) {
+                allocator_traits::destroy(allocator_, data_begin_);
+                data_begin_ = advance(data_begin_, 1);
+            }
+        }
+    }
+
     iterator erase(const_iterator q) {
         if (std::addressof(*q) < container_begin_ ||
             std::addressof(*q) >= container_end_) {
@@ -205,16 +396,25 @@ class CircularBufferCommon
     }
 
     void clear() noexcept {
-        for (auto it = cbegin(); it != cend(); ++it) {
-            allocator_traits::destroy(allocator_, std::addressof(*it));
+        if constexpr (!kTrivialDestroy) {
+            for (auto it = cbegin(); it != cend(); ++it) {
+                allocator_traits::destroy(allocator_, std::addressof(*it));
+            }
         }
         data_begin_ = container_begin_;
         data_end_ = container_begin_;
     }
 
+    // assign() and copy assignment keep the current storage, and with it the
+    // capacity, whenever the new contents fit. That path gives the basic
+    // guarantee only; replacing the storage keeps the strong guarantee.
     void assign(size_type n, const_reference value) {
-        pointer new_container_begin_ =
-            allocator_traits::allocate(allocator_, n + 1);
+        if (n <= capacity()) {
+            assign_in_place(n, [&value]() -> const_reference { return value; });
+            return;
+        }
+        size_type slots = n + 1;
+        pointer new_container_begin_ = allocate_slots(slots, container_begin_);
         try {
             auto current = new_container_begin_;
 
@@ -233,55 +433,70 @@ class CircularBufferCommon
                 throw;
             }
         } catch (...) {
-            allocator_traits::deallocate(allocator_, new_container_begin_,
-                                         n + 1);
+            deallocate_slots(new_container_begin_, slots);
             throw;
         }
 
         clear();
-        allocator_traits::deallocate(allocator_, container_begin_,
-                                     capacity() + 1);
+        deallocate_slots(container_begin_, capacity() + 1);
 
         container_begin_ = new_container_begin_;
-        container_end_ = container_begin_ + n + 1;
+        container_end_ = container_begin_ + slots;
         data_begin_ = container_begin_;
-        data_end_ = container_end_ - 1;
+        data_end_ = container_begin_ + n;
+        record_size();
     }
 
     template <typename LegacyInputIterator>
         requires std::input_iterator<LegacyInputIterator>
     void assign(LegacyInputIterator i, LegacyInputIterator j) {
         size_type n = std::distance(i, j);
+        if (n <= capacity()) {
+            assign_in_place(n, [&i]() -> decltype(auto) { return *i++; });
+            return;
+        }
 
-        pointer new_container_begin_ =
-            allocator_traits::allocate(allocator_, n + 1);
+        size_type slots = n + 1;
+        pointer new_container_begin_ = allocate_slots(slots, container_begin_);
         try {
             copy_data(i, j, new_container_begin_, allocator_);
         } catch (...) {
-            allocator_traits::deallocate(allocator_, new_container_begin_,
-                                         n + 1);
+            deallocate_slots(new_container_begin_, slots);
             throw;
         }
 
         clear();
-        allocator_traits::deallocate(allocator_, container_begin_,
-                                     capacity() + 1);
+        deallocate_slots(container_begin_, capacity() + 1);
 
         container_begin_ = new_container_begin_;
-        container_end_ = new_container_begin_ + n + 1;
+        container_end_ = new_container_begin_ + slots;
         data_begin_ = container_begin_;
-        data_end_ = container_end_ - 1;
+        data_end_ = container_begin_ + n;
+        record_size();
     }
 
     void assign(const std::initializer_list<value_type>& il) {
         assign(il.begin(), il.end());
     }
 
-    const_reference at(int n) const {
+    reference at(size_type n) {
+        if (n >= size()) {
+            throw std::out_of_range("Iterator is out of bounds");
+        }
+        return *element_slot(n);
+    }
+
+    const_reference at(size_type n) const {
         if (n >= size()) {
             throw std::out_of_range("Iterator is out of bounds");
         }
-        return *(cbegin() + n);
+        return *element_slot(n);
+    }
+
+    reference operator[](size_type i) noexcept { return *element_slot(i); }
+
+    const_reference operator[](size_type i) const noexcept {
+        return *element_slot(i);
     }
 
     bool operator==(const CircularBufferCommon& other) const noexcept {
@@ -303,7 +518,7 @@ class CircularBufferCommon
         }
 
         if (container_begin_ == data_end_) {
-            data_end_ = container_begin_ - 1;
+            data_end_ = container_end_ - 1;
         } else {
             --data_end_;
         }
@@ -331,7 +546,11 @@ class CircularBufferCommon
         return to_return;
     }
 
-    size_type size() const noexcept { return std::distance(cbegin(), cend()); }
+    size_type size() const noexcept {
+        const difference_type n = data_end_ - data_begin_;
+        return static_cast<size_type>(
+            n < 0 ? n + (container_end_ - container_begin_) : n);
+    }
 
     size_type capacity() const noexcept {
         return std::distance(container_begin_, container_end_) - 1;
@@ -378,24 +597,27 @@ class CircularBufferCommon
         if (capacity() >= n) {
             return;
         }
-        auto new_container_begin =
-            allocator_traits::allocate(allocator_, n + 1);
-        try {
-            move_data(begin(), end(), new_container_begin, allocator_);
-        } catch (...) {
-            allocator_traits::deallocate(allocator_, new_container_begin,
-                                         n + 1);
-            throw;
+        size_type slots = n + 1;
+        auto new_container_begin = allocate_slots(slots, container_begin_);
+        if constexpr (kBulkCopy) {
+            copy_segments(*this, new_container_begin);
+        } else {
+            try {
+                move_data(begin(), end(), new_container_begin, allocator_);
+            } catch (...) {
+                deallocate_slots(new_container_begin, slots);
+                throw;
+            }
         }
         auto old_n = size();
         clear();
-        allocator_traits::deallocate(allocator_, container_begin_,
-                                     capacity() + 1);
+        deallocate_slots(container_begin_, capacity() + 1);
 
         container_begin_ = new_container_begin;
-        container_end_ = container_begin_ + n + 1;
+        container_end_ = container_begin_ + slots;
         data_begin_ = container_begin_;
         data_end_ = data_begin_ + old_n;
+        stats_.on_bytes_moved(old_n * sizeof(T));
     }
 
     void resize(size_type n, const value_type& value = value_type()) {
@@ -433,6 +655,14 @@ class CircularBufferCommon
                 }
                 throw;
             }
+            record_size();
+            return;
+        }
+
+        if constexpr (kTrivialDestroy) {
+            const size_type to_end = container_end_ - data_begin_;
+            data_end_ = n < to_end ? data_begin_ + n
+                                   : container_begin_ + (n - to_end);
             return;
         }
 
@@ -448,6 +678,35 @@ class CircularBufferCommon
         }
     }
 
+    // Snapshot format: SnapshotHeader followed by size() elements, oldest
+    // first, in native byte order. Loading replaces the contents with a
+    // linearized buffer of the stored capacity.
+    void serialize(std::ostream& out) const
+        requires std::is_trivially_copyable_v<T>
+    {
+        serialize_to(out);
+    }
+
+    void deserialize(std::istream& in)
+        requires std::is_trivially_copyable_v<T>
+    {
+        deserialize_from(in);
+    }
+
+#ifdef CIRCULAR_BUFFER_HAS_FD_IO
+    void serialize(int fd) const
+        requires std::is_trivially_copyable_v<T>
+    {
+        serialize_to(fd);
+    }
+
+    void deserialize(int fd)
+        requires std::is_trivially_copyable_v<T>
+    {
+        deserialize_from(fd);
+    }
+#endif
+
    protected:
     pointer container_begin_;
     pointer container_end_;
@@ -455,44 +714,53 @@ class CircularBufferCommon
     pointer data_end_;
 
     explicit CircularBufferCommon(const Alloc& allocator = Alloc())
-        : allocator_(allocator),
-          container_begin_(allocator_traits::allocate(allocator_, 1)),
-          container_end_(container_begin_ + 1),
-          data_begin_(container_begin_),
-          data_end_(container_begin_) {}
+        : allocator_(allocator) {
+        init_storage(0);
+    }
+
+    CircularBufferCommon(CircularBufferCommon&& other) noexcept(
+        InlineCapacity == 0 || std::is_nothrow_move_constructible_v<T>)
+        : allocator_(std::move(other.allocator_)) {
+        if (!other.is_inline()) {
+            take_storage(other);
+            return;
+        }
+        init_storage(0);
+        move_data(other.begin(), other.end(), container_begin_, allocator_);
+        data_end_ = data_begin_ + other.size();
+        other.clear();
+        record_size();
+    }
 
     CircularBufferCommon(const CircularBufferCommon& other)
         : allocator_(allocator_traits::select_on_container_copy_construction(
-              other.allocator_)),
-          container_begin_(
-              allocator_traits::allocate(allocator_, other.size() + 1)),
-          container_end_(container_begin_ + other.size() + 1),
-          data_begin_(container_begin_),
-          data_end_(data_begin_ + other.size()) {
-        try {
-            copy_data(other.begin(), other.end(), container_begin_, allocator_);
-        } catch (...) {
-            allocator_traits::deallocate(allocator_, container_begin_,
-                                         capacity() + 1);
-            throw;
+              other.allocator_)) {
+        init_storage(other.size());
+        if constexpr (kBulkCopy) {
+            copy_segments(other, container_begin_);
+        } else {
+            try {
+                copy_data(other.begin(), other.end(), container_begin_,
+                          allocator_);
+            } catch (...) {
+                deallocate_slots(container_begin_, capacity() + 1);
+                throw;
+            }
         }
+        data_end_ = data_begin_ + other.size();
+        record_size();
     }
 
     explicit CircularBufferCommon(size_type size,
                                   const Alloc& allocator = Alloc())
-        : allocator_(allocator),
-          container_begin_(allocator_traits::allocate(allocator_, size + 1)),
-          container_end_(container_begin_ + size + 1),
-          data_begin_(container_begin_),
-          data_end_(container_begin_) {}
+        : allocator_(allocator) {
+        init_storage(size);
+    }
 
     CircularBufferCommon(size_type size, const_reference value,
                          const Alloc& allocator = Alloc())
-        : allocator_(allocator),
-          container_begin_(allocator_traits::allocate(allocator_, size + 1)),
-          container_end_(container_begin_ + size + 1),
-          data_begin_(container_begin_),
-          data_end_(container_end_ - 1) {
+        : allocator_(allocator) {
+        init_storage(size);
         size_type current = 0;
         try {
             for (; current < size; ++current) {
@@ -503,10 +771,11 @@ class CircularBufferCommon
             for (size_type i = 0; i < current; ++i) {
                 allocator_traits::destroy(allocator_, data_begin_ + i);
             }
-            allocator_traits::deallocate(allocator_, container_begin_,
-                                         size + 1);
+            deallocate_slots(container_begin_, capacity() + 1);
             throw;
         }
+        data_end_ = data_begin_ + size;
+        record_size();
     }
 
     template <typename LegacyInputIterator>
@@ -514,121 +783,400 @@ class CircularBufferCommon
 
     CircularBufferCommon(LegacyInputIterator i, LegacyInputIterator j,
                          const Alloc& allocator = Alloc())
-        : allocator_(allocator),
-          container_begin_(
-              allocator_traits::allocate(allocator_, std::distance(i, j) + 1)),
-          container_end_(container_begin_ + std::distance(i, j) + 1),
-          data_begin_(container_begin_),
-          data_end_(container_end_ - 1) {
+        : allocator_(allocator) {
+        const size_type n = std::distance(i, j);
+        init_storage(n);
         try {
             copy_data(i, j, data_begin_, allocator_);
         } catch (...) {
-            allocator_traits::deallocate(
-                allocator_, container_begin_,
-                std::distance(container_begin_, container_end_));
+            deallocate_slots(container_begin_, capacity() + 1);
             throw;
         }
+        data_end_ = data_begin_ + n;
+        record_size();
     }
     CircularBufferCommon(const std::initializer_list<value_type>& il,
                          const Alloc& allocator = Alloc())
-        : allocator_(allocator),
-          container_begin_(
-              allocator_traits::allocate(allocator_, il.size() + 1)),
-          container_end_(container_begin_ + il.size() + 1),
-          data_begin_(container_begin_),
-          data_end_(container_end_ - 1) {
+        : allocator_(allocator) {
+        init_storage(il.size());
         try {
             copy_data(il.begin(), il.end(), data_begin_, allocator_);
         } catch (...) {
-            allocator_traits::deallocate(allocator_, container_begin_,
-                                         il.size() + 1);
+            deallocate_slots(container_begin_, capacity() + 1);
             throw;
         }
+        data_end_ = data_begin_ + il.size();
+        record_size();
     }
 
-    CircularBufferCommon& operator=(
-        const CircularBufferCommon& other) noexcept {
+    CircularBufferCommon& operator=(const CircularBufferCommon& other) {
         if (this == &other) {
             return *this;
         }
 
         if constexpr (allocator_traits::propagate_on_container_copy_assignment::
                           value) {
-            allocator_type new_allocator = other;
-
-            auto new_containter_begin =
-                allocator_traits::allocate(new_allocator, other.size() + 1);
-            try {
-                copy_data(other.begin(), other.end(), new_containter_begin,
-                          new_allocator);
-            } catch (...) {
-                allocator_traits::deallocate(
-                    new_allocator, new_containter_begin, other.size() + 1);
-                throw;
+            if (allocator_ != other.allocator_) {
+                return assign_with_allocator(other);
             }
-
-            clear();
-            allocator_traits::deallocate(allocator_, container_begin_,
-                                         capacity() + 1);
-
-            allocator_ = std::move(new_allocator);
-            container_begin_ = new_containter_begin;
-            container_end_ = new_containter_begin + other.size() + 1;
-            data_begin_ = container_begin_;
-            data_end_ = container_end_ - 1;
-
+        }
+        if (other.size() <= capacity()) {
+            auto it = other.begin();
+            assign_in_place(other.size(),
+                            [&it]() -> const_reference { return *it++; });
             return *this;
         }
 
-        pointer new_containter_begin =
-            allocator_traits::allocate(allocator_, other.size() + 1);
+        size_type slots = other.size() + 1;
+        pointer new_containter_begin = allocate_slots(slots, container_begin_);
         try {
             copy_data(other.begin(), other.end(), new_containter_begin,
                       allocator_);
         } catch (...) {
-            allocator_traits::deallocate(allocator_, new_containter_begin,
-                                         other.size() + 1);
+            deallocate_slots(new_containter_begin, slots);
             throw;
         }
 
         clear();
-        allocator_traits::deallocate(
-            allocator_, container_begin_,
-            std::distance(container_begin_, container_end_));
+        deallocate_slots(container_begin_, capacity() + 1);
 
         container_begin_ = new_containter_begin;
-        container_end_ = new_containter_begin + other.size() + 1;
+        container_end_ = new_containter_begin + slots;
         data_begin_ = container_begin_;
-        data_end_ = container_end_ - 1;
+        data_end_ = data_begin_ + other.size();
+        record_size();
+
+        return *this;
+    }
+
+    // Takes the storage of other whenever it can be released by this
+    // allocator; otherwise moves the elements one by one.
+    CircularBufferCommon& operator=(CircularBufferCommon&& other) noexcept(
+        (allocator_traits::propagate_on_container_move_assignment::value ||
+         allocator_traits::is_always_equal::value) &&
+        InlineCapacity == 0) {
+        if (this == &other) {
+            return *this;
+        }
+
+        constexpr bool propagate =
+            allocator_traits::propagate_on_container_move_assignment::value;
+        if ((propagate || allocator_ == other.allocator_) &&
+            !other.is_inline()) {
+            clear();
+            deallocate_slots(container_begin_, capacity() + 1);
+            if constexpr (propagate) {
+                allocator_ = std::move(other.allocator_);
+            }
+            take_storage(other);
+            return *this;
+        }
 
+        move_elements(other);
         return *this;
     }
 
     CircularBufferCommon& operator=(
         const std::initializer_list<value_type>& list) {
-        pointer new_containter_begin =
-            allocator_traits::allocate(allocator_, list.size() + 1);
+        size_type slots = list.size() + 1;
+        pointer new_containter_begin = allocate_slots(slots, container_begin_);
 
         try {
             copy_data(list.begin(), list.end(), new_containter_begin,
                       allocator_);
         } catch (...) {
-            allocator_traits::deallocate(allocator_, new_containter_begin,
-                                         list.size() + 1);
+            deallocate_slots(new_containter_begin, slots);
             throw;
         }
 
         clear();
-        allocator_traits::deallocate(allocator_, container_begin_,
-                                     capacity() + 1);
+        deallocate_slots(container_begin_, capacity() + 1);
 
         container_begin_ = new_containter_begin;
-        container_end_ = container_begin_ + list.size() + 1;
+        container_end_ = container_begin_ + slots;
         data_begin_ = container_begin_;
-        data_end_ = container_end_ - 1;
+        data_end_ = data_begin_ + list.size();
+        record_size();
 
         return *this;
     }
 
+    // std::allocator constructs with placement new and destroys with a
+    // destructor call, so for trivial T both can be batched or skipped.
+    static constexpr bool kBulkCopy =
+        std::is_same_v<allocator_type, std::allocator<T>> &&
+        std::is_trivially_copyable_v<T>;
+    static constexpr bool kTrivialDestroy =
+        std::is_same_v<allocator_type, std::allocator<T>> &&
+        std::is_trivially_destructible_v<T>;
+
     allocator_type allocator_;
+    [[no_unique_address]] Stats stats_;
+    [[no_unique_address]] InlineStorage<T, InlineCapacity> inline_;
+
+    void init_storage(size_type capacity) {
+        size_type slots = capacity + 1;
+        container_begin_ = allocate_slots(slots, nullptr);
+        container_end_ = container_begin_ + slots;
+        data_begin_ = container_begin_;
+        data_end_ = container_begin_;
+    }
+
+    // Storage for slots elements, sentinel included. The inline storage is
+    // used whenever it is large enough and not the current storage; it is
+    // handed out whole, so slots is rounded up to its size.
+    pointer allocate_slots(size_type& slots, pointer current) {
+        if (slots <= InlineCapacity + 1 &&
+            (InlineCapacity == 0 || current != inline_.data())) {
+            slots = InlineCapacity + 1;
+            return inline_.data();
+        }
+        return allocator_traits::allocate(allocator_, slots);
+    }
+
+    bool is_inline() const noexcept {
+        return InlineCapacity != 0 && container_begin_ == inline_.data();
+    }
+
+    // Adopts the heap storage of other and leaves it empty.
+    void take_storage(CircularBufferCommon& other) noexcept {
+        container_begin_ = other.container_begin_;
+        container_end_ = other.container_end_;
+        data_begin_ = other.data_begin_;
+        data_end_ = other.data_end_;
+        other.init_storage(0);
+        record_size();
+    }
+
+    // Copy assignment from a buffer whose allocator propagates and differs
+    // from ours: the storage has to come from the new allocator.
+    CircularBufferCommon& assign_with_allocator(
+        const CircularBufferCommon& other) {
+        allocator_type new_allocator = other.allocator_;
+
+        auto new_containter_begin =
+            allocator_traits::allocate(new_allocator, other.size() + 1);
+        try {
+            copy_data(other.begin(), other.end(), new_containter_begin,
+                      new_allocator);
+        } catch (...) {
+            allocator_traits::deallocate(
+                new_allocator, new_containter_begin, other.size() + 1);
+            throw;
+        }
+
+        clear();
+        deallocate_slots(container_begin_, capacity() + 1);
+
+        allocator_ = std::move(new_allocator);
+        container_begin_ = new_containter_begin;
+        container_end_ = new_containter_begin + other.size() + 1;
+        data_begin_ = container_begin_;
+        data_end_ = container_end_ - 1;
+        record_size();
+
+        return *this;
+    }
+
+    // Copies the elements of source, oldest first, to uninitialized storage.
+    static void copy_segments(const CircularBufferCommon& source,
+                              pointer out) noexcept {
+        const auto first = source.first_segment();
+        const auto second = source.second_segment();
+        std::memcpy(out, first.data(), first.size_bytes());
+        if (!second.empty()) {
+            std::memcpy(out + first.size(), second.data(),
+                        second.size_bytes());
+        }
+    }
+
+    // [b][free][a] -> [a][b][free] for wrapped, trivially copyable data.
+    void rotate_segments() {
+        const auto first = first_segment();
+        const auto second = second_segment();
+        const size_type shorter = std::min(first.size(), second.size());
+        std::allocator<T> temp_allocator;
+        T* temp = temp_allocator.allocate(shorter);
+        if (second.size() <= first.size()) {
+            std::memcpy(temp, second.data(), second.size_bytes());
+            std::memmove(container_begin_, first.data(), first.size_bytes());
+            std::memcpy(container_begin_ + first.size(), temp,
+                        second.size_bytes());
+        } else {
+            std::memcpy(temp, first.data(), first.size_bytes());
+            std::memmove(container_begin_ + first.size(), second.data(),
+                         second.size_bytes());
+            std::memcpy(container_begin_, temp, first.size_bytes());
+        }
+        temp_allocator.deallocate(temp, shorter);
+    }
+
+    // Rotates all slots left by the offset of data_begin_. The permutation
+    // splits into gcd(slots, offset) cycles; a cycle entered at a free slot
+    // needs no temporary.
+    void rotate_cycles() noexcept {
+        const size_type slots = capacity() + 1;
+        const size_type shift = data_begin_ - container_begin_;
+        const size_type n = size();
+        const size_type free_slots = slots - n;
+        const size_type cycles = std::gcd(slots, shift);
+        auto is_live = [&](size_type slot) {
+            return (slot + slots - shift) % slots < n;
+        };
+
+        for (size_type cycle = 0; cycle < cycles; ++cycle) {
+            const size_type to_free =
+                (cycle + cycles - (shift + n) % cycles) % cycles;
+            const bool has_free_slot = to_free < free_slots;
+            const size_type start =
+                has_free_slot ? (shift + n + to_free) % slots : cycle;
+
+            std::optional<T> carried;
+            if (!has_free_slot) {
+                carried.emplace(std::move(container_begin_[start]));
+                allocator_traits::destroy(allocator_, container_begin_ + start);
+            }
+            size_type hole = start;
+            for (size_type next = (hole + shift) % slots; next != start;
+                 next = (hole + shift) % slots) {
+                if (is_live(next)) {
+                    allocator_traits::construct(
+                        allocator_, container_begin_ + hole,
+                        std::move(container_begin_[next]));
+                    allocator_traits::destroy(allocator_,
+                                              container_begin_ + next);
+                }
+                hole = next;
+            }
+            if (carried) {
+                allocator_traits::construct(allocator_, container_begin_ + hole,
+                                            std::move(*carried));
+            }
+        }
+    }
+
+    template <typename Next>
+    void assign_in_place(size_type n, Next next) {
+        const size_type old_size = size();
+        size_type i = 0;
+        for (auto it = begin(); i < n && i < old_size; ++i, ++it) {
+            *it = next();
+        }
+        for (; i < n; ++i) {
+            allocator_traits::construct(allocator_, data_end_, next());
+            if (data_end_ + 1 == container_end_) {
+                data_end_ = container_begin_;
+            } else {
+                ++data_end_;
+            }
+        }
+        for (; i < old_size; ++i) {
+            if (container_begin_ == data_end_) {
+                data_end_ = container_end_ - 1;
+            } else {
+                --data_end_;
+            }
+            allocator_traits::destroy(allocator_, data_end_);
+        }
+        record_size();
+    }
+
+    void move_elements(CircularBufferCommon& other) {
+        size_type slots = other.size() + 1;
+        pointer new_container_begin = allocate_slots(slots, container_begin_);
+        try {
+            move_data(other.begin(), other.end(), new_container_begin,
+                      allocator_);
+        } catch (...) {
+            deallocate_slots(new_container_begin, slots);
+            throw;
+        }
+
+        clear();
+        deallocate_slots(container_begin_, capacity() + 1);
+
+        container_begin_ = new_container_begin;
+        container_end_ = new_container_begin + slots;
+        data_begin_ = container_begin_;
+        data_end_ = data_begin_ + other.size();
+        other.clear();
+        record_size();
+    }
+
+    void deallocate_slots(pointer slots_begin, size_type slots) noexcept {
+        if (slots_begin != inline_.data()) {
+            allocator_traits::deallocate(allocator_, slots_begin, slots);
+        }
+    }
+
+    template <typename Sink>
+    void serialize_to(Sink& sink) const {
+        SnapshotHeader header;
+        header.capacity = capacity();
+        header.size = size();
+        header.element_size = sizeof(T);
+        write_bytes(sink, &header, sizeof(header));
+
+        const auto first = first_segment();
+        const auto second = second_segment();
+        write_bytes(sink, first.data(), first.size_bytes());
+        write_bytes(sink, second.data(), second.size_bytes());
+    }
+
+    template <typename Source>
+    void deserialize_from(Source& source) {
+        SnapshotHeader header;
+        read_bytes(source, &header, sizeof(header));
+        header.validate(sizeof(T), max_size());
+
+        // The elements are read into fresh storage even when the capacity
+        // matches, so a short stream leaves the buffer untouched.
+        size_type slots = header.capacity + 1;
+        pointer new_container_begin = allocate_slots(slots, container_begin_);
+        try {
+            read_bytes(source, new_container_begin, header.size * sizeof(T));
+        } catch (...) {
+            deallocate_slots(new_container_begin, slots);
+            throw;
+        }
+        clear();
+        deallocate_slots(container_begin_, capacity() + 1);
+        container_begin_ = new_container_begin;
+        container_end_ = container_begin_ + slots;
+        data_begin_ = container_begin_;
+        data_end_ = container_begin_ + header.size;
+        record_size();
+    }
+
+    // Slot of the i-th element. The offset from the start of the storage
+    // wraps at most once, so a conditional subtraction replaces the modulo.
+    pointer element_slot(size_type i) const noexcept {
+        const size_type slots = container_end_ - container_begin_;
+        size_type offset = (data_begin_ - container_begin_) + i;
+        offset -= offset >= slots ? slots : 0;
+        return container_begin_ + offset;
+    }
+
+    pointer advance(pointer p, size_type k) const noexcept {
+        const size_type to_end = container_end_ - p;
+        return k < to_end ? p + k : container_begin_ + (k - to_end);
+    }
+
+    // n slots starting at start, as the part before the end of the storage
+    // and the part wrapped around to its beginning.
+    std::pair<std::span<T>, std::span<T>> region(pointer start,
+                                                  size_type n) const noexcept {
+        const size_type to_end = container_end_ - start;
+        if (n <= to_end) {
+            return {std::span<T>(start, n), std::span<T>()};
+        }
+        return {std::span<T>(start, to_end),
+                std::span<T>(container_begin_, n - to_end)};
+    }
+
+    void record_size() noexcept {
+        if constexpr (Stats::kEnabled) {
+            stats_.on_size(size());
+        }
+    }
 };
@@ -1,87 +1,123 @@
 #pragma once
+#include <algorithm>
+
 #include "circular_buffer_common.h"
 #include "iterator/random_access_iterator.h"
 
-template <typename T, typename Alloc = std::allocator<T>>
-class CircularBufferExt : public CircularBufferCommon<T, Alloc> {
+// N elements are stored inline in the object; storage moves to the heap
+// only once the buffer grows beyond them.
+template <typename T, typename Alloc = std::allocator<T>,
+          typename Stats = NoBufferStats, std::size_t N = 0>
+class CircularBufferExt : public CircularBufferCommon<T, Alloc, Stats, N> {
    public:
-    using typename CircularBufferCommon<T, Alloc>::allocator_type;
-    using typename CircularBufferCommon<T, Alloc>::allocator_traits;
+    using typename CircularBufferCommon<T, Alloc, Stats, N>::allocator_type;
+    using typename CircularBufferCommon<T, Alloc, Stats, N>::allocator_traits;
 
-    using typename CircularBufferCommon<T, Alloc>::iterator;
-    using typename CircularBufferCommon<T, Alloc>::const_iterator;
+    using typename CircularBufferCommon<T, Alloc, Stats, N>::iterator;
+    using typename CircularBufferCommon<T, Alloc, Stats, N>::const_iterator;
 
-    using typename CircularBufferCommon<T, Alloc>::value_type;
-    using typename CircularBufferCommon<T, Alloc>::reference;
-    using typename CircularBufferCommon<T, Alloc>::pointer;
-    using typename CircularBufferCommon<T, Alloc>::const_reference;
-    using typename CircularBufferCommon<T, Alloc>::difference_type;
-    using typename CircularBufferCommon<T, Alloc>::size_type;
+    using typename CircularBufferCommon<T, Alloc, Stats, N>::value_type;
+    using typename CircularBufferCommon<T, Alloc, Stats, N>::reference;
+    using typename CircularBufferCommon<T, Alloc, Stats, N>::pointer;
+    using typename CircularBufferCommon<T, Alloc, Stats, N>::const_reference;
+    using typename CircularBufferCommon<T, Alloc, Stats, N>::difference_type;
+    using typename CircularBufferCommon<T, Alloc, Stats, N>::size_type;
+    using typename CircularBufferCommon<T, Alloc, Stats, N>::stats_type;
 
     explicit CircularBufferExt(const Alloc& allocator = Alloc())
-        : CircularBufferCommon<T, Alloc>(allocator) {}
+        : CircularBufferCommon<T, Alloc, Stats, N>(allocator) {}
 
-    explicit CircularBufferExt(CircularBufferCommon<T, Alloc>::size_type n,
-                               const Alloc& allocator = Alloc())
-        : CircularBufferCommon<T, Alloc>(n, allocator) {}
+    explicit CircularBufferExt(
+        CircularBufferCommon<T, Alloc, Stats, N>::size_type n,
+        const Alloc& allocator = Alloc())
+        : CircularBufferCommon<T, Alloc, Stats, N>(n, allocator) {}
 
-    CircularBufferExt(CircularBufferCommon<T, Alloc>::size_type n,
-                      CircularBufferCommon<T, Alloc>::value_type value,
+    CircularBufferExt(size_type n, value_type value,
                       const Alloc& allocator = Alloc())
-        : CircularBufferCommon<T, Alloc>(n, value, allocator) {}
+        : CircularBufferCommon<T, Alloc, Stats, N>(n, value, allocator) {}
 
-    CircularBufferExt(const CircularBufferExt<T, Alloc>& other)
-        : CircularBufferCommon<T, Alloc>(other) {}
+    CircularBufferExt(const CircularBufferExt<T, Alloc, Stats, N>& other)
+        : CircularBufferCommon<T, Alloc, Stats, N>(other) {}
 
     template <typename LegacyInputIterator>
     CircularBufferExt(LegacyInputIterator i, LegacyInputIterator j,
                       const Alloc& allocator = Alloc())
-        : CircularBufferCommon<T, Alloc>(i, j, allocator) {}
+        : CircularBufferCommon<T, Alloc, Stats, N>(i, j, allocator) {}
 
     CircularBufferExt(const std::initializer_list<value_type>& il,
                       const Alloc& allocator = Alloc())
-        : CircularBufferCommon<T, Alloc>(il, allocator) {}
+        : CircularBufferCommon<T, Alloc, Stats, N>(il, allocator) {}
+
+    CircularBufferExt(CircularBufferExt&& other) = default;
 
     ~CircularBufferExt() {
         clear();
-        allocator_traits::deallocate(allocator_, container_begin_,
-                                     capacity() + 1);
+        deallocate_slots(container_begin_, capacity() + 1);
     }
 
     CircularBufferExt& operator=(const CircularBufferExt& other) {
-        static_cast<CircularBufferCommon<T, Alloc>&>(*this).operator=(
-            static_cast<CircularBufferCommon<T, Alloc>&>(other));
+        CircularBufferCommon<T, Alloc, Stats, N>::operator=(other);
         return *this;
     }
 
-    using CircularBufferCommon<T, Alloc>::begin;
-    using CircularBufferCommon<T, Alloc>::end;
-    using CircularBufferCommon<T, Alloc>::cbegin;
-    using CircularBufferCommon<T, Alloc>::cend;
-    using CircularBufferCommon<T, Alloc>::swap;
-    using CircularBufferCommon<T, Alloc>::size;
-    using CircularBufferCommon<T, Alloc>::capacity;
-    using CircularBufferCommon<T, Alloc>::max_size;
-    using CircularBufferCommon<T, Alloc>::empty;
-    using CircularBufferCommon<T, Alloc>::reserve;
-    using CircularBufferCommon<T, Alloc>::resize;
-    using CircularBufferCommon<T, Alloc>::erase;
-    using CircularBufferCommon<T, Alloc>::clear;
-    using CircularBufferCommon<T, Alloc>::assign;
-    using CircularBufferCommon<T, Alloc>::pop_back;
-    using CircularBufferCommon<T, Alloc>::pop_front;
-    using CircularBufferCommon<T, Alloc>::front;
-    using CircularBufferCommon<T, Alloc>::back;
-    using CircularBufferCommon<T, Alloc>::at;
+    CircularBufferExt& operator=(CircularBufferExt&& other) = default;
+
+    using CircularBufferCommon<T, Alloc, Stats, N>::begin;
+    using CircularBufferCommon<T, Alloc, Stats, N>::end;
+    using CircularBufferCommon<T, Alloc, Stats, N>::cbegin;
+    using CircularBufferCommon<T, Alloc, Stats, N>::cend;
+    using CircularBufferCommon<T, Alloc, Stats, N>::nth;
+    using CircularBufferCommon<T, Alloc, Stats, N>::swap;
+    using CircularBufferCommon<T, Alloc, Stats, N>::size;
+    using CircularBufferCommon<T, Alloc, Stats, N>::capacity;
+    using CircularBufferCommon<T, Alloc, Stats, N>::max_size;
+    using CircularBufferCommon<T, Alloc, Stats, N>::empty;
+    using CircularBufferCommon<T, Alloc, Stats, N>::reserve;
+    using CircularBufferCommon<T, Alloc, Stats, N>::resize;
+    using CircularBufferCommon<T, Alloc, Stats, N>::erase;
+    using CircularBufferCommon<T, Alloc, Stats, N>::clear;
+    using CircularBufferCommon<T, Alloc, Stats, N>::assign;
+    using CircularBufferCommon<T, Alloc, Stats, N>::pop_back;
+    using CircularBufferCommon<T, Alloc, Stats, N>::pop_front;
+    using CircularBufferCommon<T, Alloc, Stats, N>::front;
+    using CircularBufferCommon<T, Alloc, Stats, N>::back;
+    using CircularBufferCommon<T, Alloc, Stats, N>::at;
+    using CircularBufferCommon<T, Alloc, Stats, N>::operator[];
+    using CircularBufferCommon<T, Alloc, Stats, N>::first_segment;
+    using CircularBufferCommon<T, Alloc, Stats, N>::second_segment;
+    using CircularBufferCommon<T, Alloc, Stats, N>::is_linearized;
+    using CircularBufferCommon<T, Alloc, Stats, N>::linearize;
+    using CircularBufferCommon<T, Alloc, Stats, N>::commit;
+    using CircularBufferCommon<T, Alloc, Stats, N>::peek;
+    using CircularBufferCommon<T, Alloc, Stats, N>::release;
+    using CircularBufferCommon<T, Alloc, Stats, N>::stats;
+    using CircularBufferCommon<T, Alloc, Stats, N>::reset_stats;
+    using CircularBufferCommon<T, Alloc, Stats, N>::serialize;
+    using CircularBufferCommon<T, Alloc, Stats, N>::deserialize;
 
     void swap(CircularBufferExt& other) {
-        static_cast<CircularBufferCommon<T, Alloc>&>(*this).swap(
-            static_cast<CircularBufferCommon<T, Alloc>&>(other));
+        static_cast<CircularBufferCommon<T, Alloc, Stats, N>&>(*this).swap(
+            static_cast<CircularBufferCommon<T, Alloc, Stats, N>&>(other));
+    }
+
+    // Grows the storage, like push_back(), when fewer than n slots are free.
+    std::pair<std::span<T>, std::span<T>> prepare(size_type n)
+        requires CircularBufferCommon<T, Alloc, Stats, N>::kBulkCopy
+    {
+        if (n > capacity() - size()) {
+            stats_.on_growth();
+            reserve(std::max(size() + n, capacity() * 2));
+        }
+        return CircularBufferCommon<T, Alloc, Stats, N>::prepare(n);
     }
 
     void push_back(const T& value) {
         if (size() == capacity()) {
+            // value may refer to an element of the storage being replaced.
+            const T copy(value);
             expansion(capacity());
+            push_back(copy);
+            return;
         }
 
         allocator_traits::construct(allocator_, data_end_, value);
@@ -91,11 +127,15 @@ class CircularBufferExt : public CircularBufferCommon<T, Alloc> {
         } else {
             ++data_end_;
         }
+        record_size();
     }
 
     void push_front(const T& value) {
         if (size() == capacity()) {
+            const T copy(value);
             expansion(capacity());
+            push_front(copy);
+            return;
         }
 
         pointer new_data_begin;
@@ -107,6 +147,7 @@ class CircularBufferExt : public CircularBufferCommon<T, Alloc> {
         }
         allocator_traits::construct(allocator_, new_data_begin, value);
         data_begin_ = new_data_begin;
+        record_size();
     }
 
     iterator insert(const_iterator p, const_reference value) {
@@ -148,6 +189,7 @@ class CircularBufferExt : public CircularBufferCommon<T, Alloc> {
             *last = std::move_if_noexcept(*(last - 1));
         }
         *it = value;
+        record_size();
         return it;
     }
 
@@ -200,6 +242,7 @@ class CircularBufferExt : public CircularBufferCommon<T, Alloc> {
                                         std::addressof(to_insert[i]), value);
         }
 
+        record_size();
         return to_insert;
     }
 
@@ -257,6 +300,7 @@ class CircularBufferExt : public CircularBufferCommon<T, Alloc> {
                                         std::addressof(to_insert[k]), *i);
         }
 
+        record_size();
         return to_insert;
     }
 
@@ -266,27 +310,29 @@ class CircularBufferExt : public CircularBufferCommon<T, Alloc> {
     }
 
     bool operator==(const CircularBufferExt& other) const noexcept {
-        return static_cast<const CircularBufferCommon<T, Alloc>&>(*this).
-        operator==(static_cast<const CircularBufferCommon<T, Alloc>&>(other));
+        using Common = CircularBufferCommon<T, Alloc, Stats, N>;
+        return static_cast<const Common&>(*this).operator==(
+            static_cast<const Common&>(other));
     }
 
     bool operator!=(const CircularBufferExt& other) const noexcept {
-        return static_cast<const CircularBufferCommon<T, Alloc>&>(*this).
-        operator!=(static_cast<const CircularBufferCommon<T, Alloc>&>(other));
+        using Common = CircularBufferCommon<T, Alloc, Stats, N>;
+        return static_cast<const Common&>(*this).operator!=(
+            static_cast<const Common&>(other));
     }
 
-    reference operator[](size_type i) { return *(begin() + i); }
-
-    const_reference operator[](size_type i) const { return *(cbegin() + i); }
-
    private:
-    using CircularBufferCommon<T, Alloc>::container_begin_;
-    using CircularBufferCommon<T, Alloc>::container_end_;
-    using CircularBufferCommon<T, Alloc>::data_begin_;
-    using CircularBufferCommon<T, Alloc>::data_end_;
-    using CircularBufferCommon<T, Alloc>::allocator_;
+    using CircularBufferCommon<T, Alloc, Stats, N>::container_begin_;
+    using CircularBufferCommon<T, Alloc, Stats, N>::container_end_;
+    using CircularBufferCommon<T, Alloc, Stats, N>::data_begin_;
+    using CircularBufferCommon<T, Alloc, Stats, N>::data_end_;
+    using CircularBufferCommon<T, Alloc, Stats, N>::allocator_;
+    using CircularBufferCommon<T, Alloc, Stats, N>::stats_;
+    using CircularBufferCommon<T, Alloc, Stats, N>::record_size;
+    using CircularBufferCommon<T, Alloc, Stats, N>::deallocate_slots;
 
     inline void expansion(size_type capacity) {
+        stats_.on_growth();
         if (!capacity) {
             reserve(1);
         }
@@ -294,7 +340,11 @@ class CircularBufferExt : public CircularBufferCommon<T, Alloc> {
     }
 };
 
-template <typename T, typename Alloc>
-void swap(CircularBufferExt<T, Alloc>& lhs, CircularBufferExt<T, Alloc>& rhs) {
+template <typename T, typename Alloc, typename Stats, std::size_t N>
+void swap(CircularBufferExt<T, Alloc, Stats, N>& lhs,
+          CircularBufferExt<T, Alloc, Stats, N>& rhs) {
     lhs.swap(rhs);
-}
\ No newline at end of file
+}
+
+template <typename T, std::size_t N, typename Alloc = std::allocator<T>>
+using SmallCircularBufferExt = CircularBufferExt<T, Alloc, NoBufferStats, N>;
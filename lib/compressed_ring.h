@@ -0,0 +1,358 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+#include "circular_buffer.h"
+#include "circular_buffer_ext.h"
+
+// Ring of numeric history stored as fixed-size, Gorilla-encoded blocks:
+// XOR of consecutive values for floating point T and delta-of-delta for
+// integral T. Every block is self-contained, so eviction drops the oldest
+// block as a whole and the ring holds between capacity() and
+// capacity() + block_size() most recent values. Iteration decodes lazily.
+template <typename T>
+    requires(std::is_integral_v<T> || std::is_floating_point_v<T>) &&
+            (sizeof(T) <= sizeof(std::uint64_t))
+class CompressedRing {
+    struct Block {
+        CircularBufferExt<std::uint64_t> words;
+        std::uint64_t bits = 0;
+        std::size_t count = 0;
+    };
+
+    class BitReader {
+       public:
+        BitReader() = default;
+
+        explicit BitReader(std::span<const std::uint64_t> words)
+            : words_(words.data()) {}
+
+        std::uint64_t read(unsigned n) noexcept {
+            if (n == 0) {
+                return 0;
+            }
+            const std::size_t word = position_ / 64;
+            const unsigned offset = position_ % 64;
+            position_ += n;
+
+            std::uint64_t value = words_[word] << offset;
+            if (offset + n > 64) {
+                value |= words_[word + 1] >> (64 - offset);
+            }
+            return value >> (64 - n);
+        }
+
+        bool read_bit() noexcept { return read(1) != 0; }
+
+       private:
+        const std::uint64_t* words_ = nullptr;
+        std::size_t position_ = 0;
+    };
+
+    // Encoder and decoder share the per-block prediction state.
+    struct State {
+        std::uint64_t previous = 0;
+        std::uint64_t previous_delta = 0;
+        unsigned leading = 0;
+        unsigned trailing = 0;
+    };
+
+   public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    class const_iterator {
+       public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = T;
+        using pointer = void;
+
+        const_iterator() = default;
+
+        T operator*() const noexcept { return current_; }
+
+        const_iterator& operator++() {
+            ++index_;
+            load();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            auto old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator& other) const noexcept {
+            return block_ == other.block_ && index_ == other.index_;
+        }
+
+        bool operator!=(const const_iterator& other) const noexcept {
+            return !(*this == other);
+        }
+
+       private:
+        friend class CompressedRing;
+
+        const CompressedRing* ring_ = nullptr;
+        size_type block_ = 0;
+        size_type index_ = 0;
+        BitReader reader_;
+        State state_;
+        T current_ = T();
+
+        const_iterator(const CompressedRing* ring, size_type block)
+            : ring_(ring), block_(block) {
+            open_block();
+            load();
+        }
+
+        const Block* block() const {
+            if (block_ < ring_->sealed_.size()) {
+                return &ring_->sealed_[block_];
+            }
+            return block_ == ring_->sealed_.size() ? &ring_->open_ : nullptr;
+        }
+
+        void open_block() {
+            const Block* current = block();
+            index_ = 0;
+            state_ = State();
+            reader_ = current ? BitReader(current->words.first_segment())
+                              : BitReader();
+        }
+
+        void load() {
+            const Block* current = block();
+            while (current != nullptr && index_ == current->count) {
+                if (block_ == ring_->sealed_.size()) {
+                    return;
+                }
+                ++block_;
+                open_block();
+                current = block();
+            }
+            if (current != nullptr) {
+                current_ = decode(reader_, state_, index_);
+            }
+        }
+    };
+
+    explicit CompressedRing(size_type capacity, size_type block_size = 128)
+        : block_size_(block_size),
+          sealed_((capacity + block_size - 1) / block_size) {
+        if (block_size == 0) {
+            throw std::invalid_argument("Block size must be > 0");
+        }
+    }
+
+    void push_back(const T& value) {
+        if (sealed_.capacity() == 0 && open_.count == block_size_) {
+            open_ = Block();
+            encoder_ = State();
+        }
+        encode(value);
+        if (open_.count == block_size_ && sealed_.capacity() != 0) {
+            sealed_.push_back(open_);
+            open_ = Block();
+            encoder_ = State();
+        }
+    }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+
+    const_iterator end() const {
+        const_iterator it;
+        it.ring_ = this;
+        it.block_ = sealed_.size();
+        it.index_ = open_.count;
+        return it;
+    }
+
+    size_type size() const noexcept {
+        return sealed_.size() * block_size_ + open_.count;
+    }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    size_type capacity() const noexcept {
+        return sealed_.capacity() * block_size_;
+    }
+
+    size_type block_size() const noexcept { return block_size_; }
+
+    void clear() noexcept {
+        sealed_.clear();
+        open_ = Block();
+        encoder_ = State();
+    }
+
+    // Bytes of encoded payload currently held, sealed and open blocks.
+    size_type memory_usage() const noexcept {
+        size_type bytes = open_.words.capacity() * sizeof(std::uint64_t);
+        for (const Block& block : sealed_) {
+            bytes += block.words.capacity() * sizeof(std::uint64_t);
+        }
+        return bytes + sealed_.capacity() * sizeof(Block);
+    }
+
+   private:
+    size_type block_size_;
+    CircularBuffer<Block> sealed_;
+    Block open_;
+    State encoder_;
+
+    static std::uint64_t to_bits(T value) noexcept {
+        if constexpr (std::is_floating_point_v<T>) {
+            return std::bit_cast<std::uint64_t>(static_cast<double>(value));
+        } else {
+            return static_cast<std::uint64_t>(value);
+        }
+    }
+
+    static T from_bits(std::uint64_t bits) noexcept {
+        if constexpr (std::is_floating_point_v<T>) {
+            return static_cast<T>(std::bit_cast<double>(bits));
+        } else {
+            return static_cast<T>(bits);
+        }
+    }
+
+    static std::uint64_t zigzag(std::uint64_t value) noexcept {
+        return (value << 1) ^
+               static_cast<std::uint64_t>(static_cast<std::int64_t>(value) >>
+                                          63);
+    }
+
+    static std::uint64_t unzigzag(std::uint64_t value) noexcept {
+        return (value >> 1) ^ (~(value & 1) + 1);
+    }
+
+    void write(std::uint64_t value, unsigned n) {
+        if (n == 0) {
+            return;
+        }
+        if (n < 64) {
+            value &= (std::uint64_t{1} << n) - 1;
+        }
+        const unsigned offset = open_.bits % 64;
+        if (offset == 0) {
+            open_.words.push_back(0);
+        }
+        auto words = open_.words.first_segment();
+        std::uint64_t& last = words[words.size() - 1];
+        const unsigned room = 64 - offset;
+        if (n <= room) {
+            last |= value << (room - n);
+        } else {
+            last |= value >> (n - room);
+            open_.words.push_back(value << (64 - (n - room)));
+        }
+        open_.bits += n;
+    }
+
+    void encode(const T& value) {
+        const std::uint64_t bits = to_bits(value);
+        if (open_.count == 0) {
+            write(bits, 64);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            encode_xor(bits);
+        } else {
+            encode_delta(bits);
+        }
+        encoder_.previous = bits;
+        ++open_.count;
+    }
+
+    void encode_xor(std::uint64_t bits) {
+        const std::uint64_t x = bits ^ encoder_.previous;
+        if (x == 0) {
+            write(0, 1);
+            return;
+        }
+        unsigned leading = std::countl_zero(x);
+        const unsigned trailing = std::countr_zero(x);
+        leading = leading > 31 ? 31 : leading;
+
+        if (encoder_.leading + encoder_.trailing != 0 &&
+            leading >= encoder_.leading && trailing >= encoder_.trailing) {
+            write(0b10, 2);
+            write(x >> encoder_.trailing,
+                  64 - encoder_.leading - encoder_.trailing);
+            return;
+        }
+        const unsigned meaningful = 64 - leading - trailing;
+        write(0b11, 2);
+        write(leading, 5);
+        write(meaningful - 1, 6);
+        write(x >> trailing, meaningful);
+        encoder_.leading = leading;
+        encoder_.trailing = trailing;
+    }
+
+    void encode_delta(std::uint64_t bits) {
+        const std::uint64_t delta = bits - encoder_.previous;
+        const std::uint64_t dod = zigzag(delta - encoder_.previous_delta);
+        encoder_.previous_delta = delta;
+
+        if (dod == 0) {
+            write(0, 1);
+        } else if (dod < (std::uint64_t{1} << 7)) {
+            write(0b10, 2);
+            write(dod, 7);
+        } else if (dod < (std::uint64_t{1} << 9)) {
+            write(0b110, 3);
+            write(dod, 9);
+        } else if (dod < (std::uint64_t{1} << 12)) {
+            write(0b1110, 4);
+            write(dod, 12);
+        } else {
+            write(0b1111, 4);
+            write(dod, 64);
+        }
+    }
+
+    static T decode(BitReader& reader, State& state, size_type index) {
+        if (index == 0) {
+            state.previous = reader.read(64);
+            return from_bits(state.previous);
+        }
+        if constexpr (std::is_floating_point_v<T>) {
+            if (reader.read_bit()) {
+                if (reader.read_bit()) {
+                    state.leading = static_cast<unsigned>(reader.read(5));
+                    const unsigned meaningful =
+                        static_cast<unsigned>(reader.read(6)) + 1;
+                    state.trailing = 64 - state.leading - meaningful;
+                }
+                const unsigned meaningful =
+                    64 - state.leading - state.trailing;
+                state.previous ^= reader.read(meaningful) << state.trailing;
+            }
+        } else {
+            std::uint64_t dod = 0;
+            if (reader.read_bit()) {
+                if (!reader.read_bit()) {
+                    dod = reader.read(7);
+                } else if (!reader.read_bit()) {
+                    dod = reader.read(9);
+                } else if (!reader.read_bit()) {
+                    dod = reader.read(12);
+                } else {
+                    dod = reader.read(64);
+                }
+            }
+            state.previous_delta += unzigzag(dod);
+            state.previous += state.previous_delta;
+        }
+        return from_bits(state.previous);
+    }
+};
@@ -37,7 +37,7 @@ class Iterator {
 
     reference operator*() const noexcept { return *current_; }
 
-    reference operator->() const noexcept { return current_; }
+    pointer operator->() const noexcept { return current_; }
 
     reference operator[](std::size_t n) const noexcept {
         return *this->operator+(n);
@@ -54,7 +54,7 @@ class Iterator {
         return *this;
     }
 
-    Iterator operator++(int) const noexcept {
+    Iterator operator++(int) noexcept {
         if (container_begin_ + 1 == container_end_) return *this;
 
         const auto old = current_;
@@ -79,7 +79,7 @@ class Iterator {
 
         return *this;
     }
-    Iterator operator--(int) const noexcept {
+    Iterator operator--(int) noexcept {
         if (container_begin_ + 1 == container_end_) return *this;
 
         const auto old = current_;
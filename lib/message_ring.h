@@ -0,0 +1,164 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "record_ring.h"
+
+// Queue of messages of the listed types, each constructed in place in a
+// RecordRing with only its own size, a small type tag and any alignment
+// padding, instead of the largest type's size as in a std::variant slot.
+// visit() calls f(U&) on the oldest message with its actual type and then
+// destroys it where it lies.
+template <typename... Types>
+class MessageRing {
+    static_assert(sizeof...(Types) > 0, "MessageRing needs message types");
+
+   public:
+    using size_type = std::size_t;
+
+    explicit MessageRing(size_type capacity) : ring_(capacity) {}
+
+    MessageRing(const MessageRing&) = delete;
+    MessageRing& operator=(const MessageRing&) = delete;
+
+    ~MessageRing() {
+        while (!ring_.empty()) {
+            destroy_front();
+        }
+    }
+
+    // Constructs a U from args at the back. Returns false, without
+    // constructing anything, when the ring has no room for it.
+    template <typename U, typename... Args>
+    bool emplace(Args&&... args) {
+        constexpr std::uint32_t tag = index_of<U>();
+        static_assert(tag < sizeof...(Types), "U is not a message type");
+
+        const auto record = ring_.try_write(bytes_for<U>());
+        if (record.data() == nullptr) {
+            return false;
+        }
+        const auto address =
+            reinterpret_cast<std::uintptr_t>(record.data() + kPrefixSize);
+        const auto offset = static_cast<std::uint32_t>(
+            kPrefixSize + (-address & (alignof(U) - 1)));
+        // A constructor that throws leaves an empty record behind, which
+        // visit() skips.
+        set_prefix(record.data(), Prefix{kEmpty, offset});
+        ::new (static_cast<void*>(record.data() + offset))
+            U(std::forward<Args>(args)...);
+        set_prefix(record.data(), Prefix{tag, offset});
+        return true;
+    }
+
+    // Calls f(U&) on the oldest message, then destroys and removes it even
+    // if f throws. Returns false when there is no message.
+    template <typename F>
+    bool visit(F&& f) {
+        for (;;) {
+            const auto record = ring_.front();
+            if (record.data() == nullptr) {
+                return false;
+            }
+            const Prefix prefix = get_prefix(record.data());
+            if (prefix.tag == kEmpty) {
+                ring_.pop();
+                continue;
+            }
+            try {
+                dispatch(prefix.tag, record.data() + prefix.offset, f);
+            } catch (...) {
+                destroy_front();
+                throw;
+            }
+            destroy_front();
+            return true;
+        }
+    }
+
+    // Visits every message, oldest first. Returns how many there were.
+    template <typename F>
+    size_type visit_all(F&& f) {
+        size_type visited = 0;
+        while (visit(f)) {
+            ++visited;
+        }
+        return visited;
+    }
+
+    // Counts the empty records left by throwing constructors as well.
+    size_type size() const noexcept { return ring_.size(); }
+
+    bool empty() const noexcept { return ring_.empty(); }
+
+    size_type bytes_used() const noexcept { return ring_.bytes_used(); }
+
+    size_type capacity() const noexcept { return ring_.capacity(); }
+
+   private:
+    struct Prefix {
+        std::uint32_t tag;
+        std::uint32_t offset;
+    };
+
+    static constexpr std::uint32_t kEmpty = ~std::uint32_t{0};
+    static constexpr size_type kPrefixSize = RecordRing::kAlignment;
+
+    static_assert(sizeof(Prefix) <= kPrefixSize);
+
+    RecordRing ring_;
+
+    template <typename U>
+    static constexpr std::uint32_t index_of() noexcept {
+        std::uint32_t index = 0;
+        ((std::is_same_v<U, Types> ? false : (++index, true)) && ...);
+        return index;
+    }
+
+    // Prefix, the object, and room to align it past the record alignment.
+    template <typename U>
+    static constexpr size_type bytes_for() noexcept {
+        return kPrefixSize + sizeof(U) +
+               (alignof(U) > RecordRing::kAlignment
+                    ? alignof(U) - RecordRing::kAlignment
+                    : 0);
+    }
+
+    static Prefix get_prefix(const std::byte* record) noexcept {
+        Prefix prefix;
+        std::memcpy(&prefix, record, sizeof(prefix));
+        return prefix;
+    }
+
+    static void set_prefix(std::byte* record, Prefix prefix) noexcept {
+        std::memcpy(record, &prefix, sizeof(prefix));
+    }
+
+    template <typename F>
+    static void dispatch(std::uint32_t tag, std::byte* object, F&& f) {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((tag == I ? (f(*std::launder(reinterpret_cast<
+                             std::tuple_element_t<I, std::tuple<Types...>>*>(
+                             object))),
+                          true)
+                       : false) ||
+             ...);
+        }(std::index_sequence_for<Types...>());
+    }
+
+    void destroy_front() noexcept {
+        const auto record = ring_.front();
+        const Prefix prefix = get_prefix(record.data());
+        if (prefix.tag != kEmpty) {
+            dispatch(prefix.tag, record.data() + prefix.offset,
+                     [](auto& message) { std::destroy_at(&message); });
+        }
+        ring_.pop();
+    }
+};
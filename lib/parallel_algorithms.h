@@ -0,0 +1,385 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <thread>
+#include <utility>
+
+#include "circular_buffer_ext.h"
+
+// Parallel counterparts of for_each / transform / reduce / count_if / sort
+// for CircularBuffer and CircularBufferExt. Elements are addressed through
+// the two contiguous storage segments, split into chunks of consecutive
+// logical indices that run on a ThreadPool.
+namespace parallel {
+
+class ThreadPool {
+   public:
+    explicit ThreadPool(std::size_t threads = default_threads())
+        : threads_(threads), workers_(new std::thread[threads]) {
+        for (std::size_t i = 0; i < threads_; ++i) {
+            workers_[i] = std::thread([this] { work(); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        ready_.notify_all();
+        for (std::size_t i = 0; i < threads_; ++i) {
+            workers_[i].join();
+        }
+    }
+
+    std::size_t size() const noexcept { return threads_; }
+
+    // Runs task(0) ... task(count - 1) on the workers and the calling
+    // thread, returning once every call has finished. The first exception
+    // thrown by a call is rethrown here. Only helpers that start before the
+    // caller runs out of calls join the job, so a run() from inside a task
+    // finishes on its own thread even when every worker is busy; helpers
+    // that start later find the job closed and return.
+    template <typename Task>
+    void run(std::size_t count, Task& task) {
+        const std::size_t helpers = std::min(count ? count - 1 : 0, threads_);
+        auto job = std::make_shared<Job>();
+        if (helpers != 0) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (std::size_t i = 0; i < helpers; ++i) {
+                    tasks_.push_back([job, &task, count] {
+                        {
+                            std::lock_guard<std::mutex> guard(job->mutex);
+                            if (job->closed) {
+                                return;
+                            }
+                            ++job->active;
+                        }
+                        drain(*job, task, count);
+                        std::lock_guard<std::mutex> guard(job->mutex);
+                        if (--job->active == 0) {
+                            job->idle.notify_all();
+                        }
+                    });
+                }
+            }
+            ready_.notify_all();
+        }
+
+        drain(*job, task, count);
+        std::unique_lock<std::mutex> lock(job->mutex);
+        job->closed = true;
+        job->idle.wait(lock, [&job] { return job->active == 0; });
+        if (job->error) {
+            std::rethrow_exception(job->error);
+        }
+    }
+
+    static ThreadPool& shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+   private:
+    // Shared with the queued helper tasks, which may outlive run().
+    struct Job {
+        std::atomic<std::size_t> next{0};
+        std::mutex mutex;
+        std::condition_variable idle;
+        std::size_t active = 0;
+        bool closed = false;
+        std::exception_ptr error;
+    };
+
+    std::size_t threads_;
+    std::unique_ptr<std::thread[]> workers_;
+    CircularBufferExt<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    bool stopping_ = false;
+
+    static std::size_t default_threads() noexcept {
+        return std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    template <typename Task>
+    static void drain(Job& job, Task& task, std::size_t count) noexcept {
+        for (std::size_t i = job.next++; i < count; i = job.next++) {
+            try {
+                task(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(job.mutex);
+                if (!job.error) {
+                    job.error = std::current_exception();
+                }
+            }
+        }
+    }
+
+    void work() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_.wait(lock,
+                            [this] { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return;
+                }
+                task = tasks_.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+namespace detail {
+
+inline constexpr std::size_t kMinChunk = std::size_t{1} << 14;
+
+// Chunk c covers logical indices [c * step, min(n, (c + 1) * step)).
+struct Plan {
+    Plan(std::size_t size, const ThreadPool& pool) : n(size) {
+        const std::size_t by_size = (n + kMinChunk - 1) / kMinChunk;
+        const std::size_t wanted =
+            std::max<std::size_t>(1, std::min(by_size, (pool.size() + 1) * 4));
+        step = std::max<std::size_t>(1, (n + wanted - 1) / wanted);
+        chunks = (n + step - 1) / step;
+    }
+
+    std::size_t begin(std::size_t chunk) const noexcept {
+        return chunk * step;
+    }
+
+    std::size_t end(std::size_t chunk) const noexcept {
+        return std::min(n, (chunk + 1) * step);
+    }
+
+    std::size_t n;
+    std::size_t step;
+    std::size_t chunks;
+};
+
+// Calls f(piece, offset) for the parts of logical range [begin, end) that
+// lie in the first and in the second segment.
+template <typename U, typename F>
+void for_each_piece(std::span<U> first, std::span<U> second,
+                    std::size_t begin, std::size_t end, F&& f) {
+    if (begin < first.size()) {
+        const std::size_t stop = std::min(end, first.size());
+        f(first.subspan(begin, stop - begin), begin);
+    }
+    if (end > first.size()) {
+        const std::size_t from = std::max(begin, first.size());
+        f(second.subspan(from - first.size(), end - from), from);
+    }
+}
+
+// Runs f(chunk, piece, offset) over every chunk of buffer in parallel.
+template <typename Buffer, typename F>
+void for_each_chunk(Buffer& buffer, const Plan& plan, ThreadPool& pool,
+                    F&& f) {
+    const auto first = buffer.first_segment();
+    const auto second = buffer.second_segment();
+    auto task = [&](std::size_t chunk) {
+        for_each_piece(first, second, plan.begin(chunk), plan.end(chunk),
+                       [&](auto piece, std::size_t offset) {
+                           f(chunk, piece, offset);
+                       });
+    };
+    pool.run(plan.chunks, task);
+}
+
+// Uninitialized storage for plan.n elements. Chunks are marked once their
+// elements are constructed, and the marked chunks are destroyed with it.
+template <typename T>
+class Scratch {
+   public:
+    explicit Scratch(const Plan& plan)
+        : plan_(plan),
+          data_(allocator_.allocate(plan.n)),
+          built_(std::make_unique<bool[]>(plan.chunks)) {}
+
+    Scratch(const Scratch&) = delete;
+    Scratch& operator=(const Scratch&) = delete;
+
+    ~Scratch() {
+        for (std::size_t chunk = 0; chunk < plan_.chunks; ++chunk) {
+            if (built_[chunk]) {
+                std::destroy(data_ + plan_.begin(chunk),
+                             data_ + plan_.end(chunk));
+            }
+        }
+        allocator_.deallocate(data_, plan_.n);
+    }
+
+    T* data() const noexcept { return data_; }
+
+    bool built(std::size_t chunk) const noexcept { return built_[chunk]; }
+
+    void mark_built(std::size_t chunk) noexcept { built_[chunk] = true; }
+
+   private:
+    std::allocator<T> allocator_;
+    const Plan& plan_;
+    T* data_;
+    std::unique_ptr<bool[]> built_;
+};
+
+template <typename Buffer>
+std::size_t size_of(const Buffer& buffer) noexcept {
+    return buffer.first_segment().size() + buffer.second_segment().size();
+}
+
+}  // namespace detail
+
+template <typename Buffer, typename F>
+void for_each(Buffer& buffer, F f, ThreadPool& pool = ThreadPool::shared()) {
+    const detail::Plan plan(detail::size_of(buffer), pool);
+    detail::for_each_chunk(buffer, plan, pool,
+                           [&](std::size_t, auto piece, std::size_t) {
+                               std::for_each(piece.begin(), piece.end(), f);
+                           });
+}
+
+// Writes op(buffer[i]) to out[i]; returns out + buffer.size().
+template <typename Buffer, typename OutputIt, typename UnaryOp>
+    requires std::random_access_iterator<OutputIt>
+OutputIt transform(const Buffer& buffer, OutputIt out, UnaryOp op,
+                   ThreadPool& pool = ThreadPool::shared()) {
+    const detail::Plan plan(detail::size_of(buffer), pool);
+    detail::for_each_chunk(
+        buffer, plan, pool, [&](std::size_t, auto piece, std::size_t offset) {
+            std::transform(piece.begin(), piece.end(), out + offset, op);
+        });
+    return out + plan.n;
+}
+
+// Every chunk is folded left to right and the chunk results are then
+// folded in order onto init, so for an associative op the result equals
+// the sequential left fold.
+template <typename Buffer, typename T, typename BinaryOp = std::plus<>>
+T reduce(const Buffer& buffer, T init, BinaryOp op = BinaryOp(),
+         ThreadPool& pool = ThreadPool::shared()) {
+    const detail::Plan plan(detail::size_of(buffer), pool);
+    auto partials = std::make_unique<std::optional<T>[]>(plan.chunks);
+    detail::for_each_chunk(
+        buffer, plan, pool, [&](std::size_t chunk, auto piece, std::size_t) {
+            T local = piece[0];
+            for (std::size_t i = 1; i < piece.size(); ++i) {
+                local = op(std::move(local), piece[i]);
+            }
+            std::optional<T>& partial = partials[chunk];
+            partial = partial ? op(std::move(*partial), std::move(local))
+                              : std::move(local);
+        });
+    for (std::size_t chunk = 0; chunk < plan.chunks; ++chunk) {
+        init = op(std::move(init), std::move(*partials[chunk]));
+    }
+    return init;
+}
+
+template <typename Buffer, typename Predicate>
+std::size_t count_if(const Buffer& buffer, Predicate predicate,
+                     ThreadPool& pool = ThreadPool::shared()) {
+    const detail::Plan plan(detail::size_of(buffer), pool);
+    auto counts = std::make_unique<std::size_t[]>(plan.chunks);
+    detail::for_each_chunk(
+        buffer, plan, pool, [&](std::size_t chunk, auto piece, std::size_t) {
+            counts[chunk] += static_cast<std::size_t>(
+                std::count_if(piece.begin(), piece.end(), predicate));
+        });
+    std::size_t total = 0;
+    for (std::size_t chunk = 0; chunk < plan.chunks; ++chunk) {
+        total += counts[chunk];
+    }
+    return total;
+}
+
+// Moves the elements into one scratch array, sorts the chunks in parallel,
+// merges them pairwise in log2(chunks) parallel rounds and moves the
+// result back in logical order. If comp throws, the elements are moved
+// back before the exception propagates, so the buffer keeps its elements
+// in an unspecified order; a throwing move constructor only loses the
+// elements of the chunk it failed in.
+template <typename Buffer, typename Compare = std::less<>>
+void sort(Buffer& buffer, Compare comp = Compare(),
+          ThreadPool& pool = ThreadPool::shared()) {
+    using T = typename Buffer::value_type;
+    const detail::Plan plan(detail::size_of(buffer), pool);
+    if (plan.n < 2) {
+        return;
+    }
+    detail::Scratch<T> scratch(plan);
+    T* data = scratch.data();
+    const auto first = buffer.first_segment();
+    const auto second = buffer.second_segment();
+
+    auto move_in = [&](std::size_t chunk) {
+        const std::size_t begin = plan.begin(chunk);
+        std::size_t built = begin;
+        try {
+            detail::for_each_piece(
+                first, second, begin, plan.end(chunk),
+                [&](auto piece, std::size_t offset) {
+                    std::uninitialized_move(piece.begin(), piece.end(),
+                                            data + offset);
+                    built = offset + piece.size();
+                });
+        } catch (...) {
+            std::destroy(data + begin, data + built);
+            throw;
+        }
+        scratch.mark_built(chunk);
+    };
+    // Chunks whose move failed are skipped on the way back.
+    auto move_back = [&](std::size_t chunk) {
+        if (!scratch.built(chunk)) {
+            return;
+        }
+        detail::for_each_piece(
+            first, second, plan.begin(chunk), plan.end(chunk),
+            [&](auto piece, std::size_t offset) {
+                std::move(data + offset, data + offset + piece.size(),
+                          piece.begin());
+            });
+    };
+    try {
+        pool.run(plan.chunks, move_in);
+
+        auto sort_chunk = [&](std::size_t chunk) {
+            std::sort(data + plan.begin(chunk), data + plan.end(chunk), comp);
+        };
+        pool.run(plan.chunks, sort_chunk);
+
+        for (std::size_t width = plan.step; width < plan.n; width *= 2) {
+            auto merge_pair = [&](std::size_t pair) {
+                const std::size_t begin = pair * 2 * width;
+                const std::size_t middle = std::min(plan.n, begin + width);
+                const std::size_t end = std::min(plan.n, begin + 2 * width);
+                std::inplace_merge(data + begin, data + middle, data + end,
+                                   comp);
+            };
+            pool.run((plan.n + 2 * width - 1) / (2 * width), merge_pair);
+        }
+    } catch (...) {
+        pool.run(plan.chunks, move_back);
+        throw;
+    }
+    pool.run(plan.chunks, move_back);
+}
+
+}  // namespace parallel
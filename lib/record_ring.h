@@ -0,0 +1,209 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+
+// Byte ring of variable-length records, each stored contiguously behind a
+// length header. A record never straddles the end of the storage: when it
+// does not fit before the end, a skip marker fills the tail and the record
+// starts over at offset 0. Payloads are kAlignment-aligned.
+class RecordRing {
+   public:
+    using size_type = std::size_t;
+
+    static constexpr size_type kAlignment = 8;
+
+    // Forward iterator over the stored records, oldest first.
+    class iterator {
+       public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::span<const std::byte>;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+
+        iterator(const RecordRing* ring, size_type position,
+                 size_type remaining)
+            : ring_(ring), position_(position), remaining_(remaining) {
+            skip_marker();
+        }
+
+        value_type operator*() const noexcept {
+            return ring_->payload(position_);
+        }
+
+        iterator& operator++() noexcept {
+            position_ = ring_->next(position_);
+            --remaining_;
+            skip_marker();
+            return *this;
+        }
+
+        iterator operator++(int) noexcept {
+            auto old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const iterator& other) const noexcept {
+            return remaining_ == other.remaining_;
+        }
+
+       private:
+        const RecordRing* ring_ = nullptr;
+        size_type position_ = 0;
+        size_type remaining_ = 0;
+
+        void skip_marker() noexcept {
+            if (remaining_ != 0 && ring_->header(position_) == kSkip) {
+                position_ = 0;
+            }
+        }
+    };
+
+    // capacity is rounded up to a multiple of kAlignment.
+    explicit RecordRing(size_type capacity)
+        : capacity_(round_up(capacity)),
+          storage_(new std::byte[capacity_]) {
+        if (capacity_ < kHeaderSize) {
+            throw std::invalid_argument("RecordRing capacity must be > 0");
+        }
+    }
+
+    RecordRing(const RecordRing&) = delete;
+    RecordRing& operator=(const RecordRing&) = delete;
+
+    // Reserves a record of size bytes and returns its payload to be filled
+    // in place. Returns a span with a null data() when the free space, less
+    // any skip marker the record needs, is too small. Throws when the
+    // record could never fit.
+    std::span<std::byte> try_write(size_type size) {
+        if (size > max_record_size()) {
+            throw std::invalid_argument("Record larger than the RecordRing");
+        }
+        // wrap() keeps write_ below capacity_. Saying so here lets GCC see
+        // that the headers written below stay inside the storage.
+        if (write_ >= capacity_) {
+            return {};
+        }
+        const size_type need = record_bytes(size);
+        const size_type to_end = capacity_ - write_;
+        const size_type skip = need > to_end ? to_end : 0;
+        if (used_ + skip + need > capacity_) {
+            return {};
+        }
+        if (skip != 0) {
+            set_header(write_, kSkip);
+            write_ = 0;
+        }
+        set_header(write_, static_cast<Header>(size));
+        std::byte* data = storage_.get() + write_ + kHeaderSize;
+        write_ = wrap(write_ + need);
+        used_ += skip + need;
+        ++records_;
+        return {data, size};
+    }
+
+    // Removes the oldest record and returns its payload, which stays valid
+    // until the next try_write(). A span with a null data() when empty.
+    std::span<const std::byte> read() noexcept {
+        const auto record = front();
+        pop();
+        return record;
+    }
+
+    // The oldest record, left in the ring. A span with a null data() when
+    // empty.
+    std::span<std::byte> front() noexcept {
+        if (records_ == 0) {
+            return {};
+        }
+        if (header(read_) == kSkip) {
+            used_ -= capacity_ - read_;
+            read_ = 0;
+        }
+        return {storage_.get() + read_ + kHeaderSize, header(read_)};
+    }
+
+    // Removes the oldest record; does nothing when empty.
+    void pop() noexcept {
+        if (front().data() == nullptr) {
+            return;
+        }
+        const size_type next_read = next(read_);
+        used_ -= record_bytes(header(read_));
+        if (--records_ == 0) {
+            // Start over at offset 0 to leave the most contiguous room.
+            read_ = write_ = used_ = 0;
+        } else {
+            read_ = next_read;
+        }
+    }
+
+    iterator begin() const noexcept { return iterator(this, read_, records_); }
+
+    iterator end() const noexcept { return iterator(this, 0, 0); }
+
+    size_type size() const noexcept { return records_; }
+
+    bool empty() const noexcept { return records_ == 0; }
+
+    // Bytes taken by headers, payloads, padding and skip markers.
+    size_type bytes_used() const noexcept { return used_; }
+
+    size_type capacity() const noexcept { return capacity_; }
+
+    size_type max_record_size() const noexcept {
+        const size_type room = capacity_ - kHeaderSize;
+        return room < kSkip ? room : kSkip - 1;
+    }
+
+   private:
+    using Header = std::uint32_t;
+
+    static constexpr Header kSkip = ~Header{0};
+    static constexpr size_type kHeaderSize = kAlignment;
+
+    static_assert(kAlignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+
+    size_type capacity_;
+    std::unique_ptr<std::byte[]> storage_;
+    size_type read_ = 0;
+    size_type write_ = 0;
+    size_type used_ = 0;
+    size_type records_ = 0;
+
+    static size_type round_up(size_type n) noexcept {
+        return (n + kAlignment - 1) / kAlignment * kAlignment;
+    }
+
+    static size_type record_bytes(size_type size) noexcept {
+        return kHeaderSize + round_up(size);
+    }
+
+    size_type wrap(size_type position) const noexcept {
+        return position == capacity_ ? 0 : position;
+    }
+
+    Header header(size_type position) const noexcept {
+        Header value;
+        std::memcpy(&value, storage_.get() + position, sizeof(value));
+        return value;
+    }
+
+    void set_header(size_type position, Header value) noexcept {
+        std::memcpy(storage_.get() + position, &value, sizeof(value));
+    }
+
+    std::span<const std::byte> payload(size_type position) const noexcept {
+        return {storage_.get() + position + kHeaderSize, header(position)};
+    }
+
+    size_type next(size_type position) const noexcept {
+        return wrap(position + record_bytes(header(position)));
+    }
+};
@@ -0,0 +1,206 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+// Fan-in queue made of one single-producer/single-consumer ring per shard.
+// Each producer thread owns a shard and pushes into it alone; one consumer
+// thread drains all of them. A producer only writes its own shard's tail
+// and slots, which sit on cache lines no other shard uses, so producers
+// never contend with each other. The consumer works in batches: one
+// acquire load of a shard's tail and one release store of its head cover
+// every element it takes from that shard in a pass.
+template <typename T, typename Alloc = std::allocator<T>>
+class ShardedRing {
+   public:
+    using allocator_type =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+    using allocator_traits =
+        typename std::allocator_traits<Alloc>::template rebind_traits<T>;
+
+    using value_type = T;
+    using pointer = T*;
+    using size_type = std::size_t;
+    using sequence_type = std::uint64_t;
+
+    // No limit on the elements taken from one shard per pass.
+    static constexpr size_type kUnbounded = static_cast<size_type>(-1);
+
+    ShardedRing(size_type shards, size_type capacity,
+                const Alloc& allocator = Alloc())
+        : allocator_(allocator),
+          shard_count_(shards),
+          capacity_(capacity),
+          stride_(capacity + (kCacheLine + sizeof(T) - 1) / sizeof(T)),
+          shards_(new Shard[shards]) {
+        if (shards == 0 || capacity == 0) {
+            throw std::invalid_argument(
+                "ShardedRing needs at least one shard and one slot");
+        }
+        slots_ = allocator_traits::allocate(allocator_, shards * stride_);
+    }
+
+    ShardedRing(const ShardedRing&) = delete;
+    ShardedRing& operator=(const ShardedRing&) = delete;
+
+    ~ShardedRing() {
+        for (size_type s = 0; s < shard_count_; ++s) {
+            const Shard& shard = shards_[s];
+            const sequence_type tail = shard.tail.load();
+            for (sequence_type seq = shard.head.load(); seq != tail; ++seq) {
+                allocator_traits::destroy(allocator_, slot(s, seq));
+            }
+        }
+        allocator_traits::deallocate(allocator_, slots_,
+                                     shard_count_ * stride_);
+    }
+
+    // Producer side. Only the thread that owns shard may call these.
+    bool try_push(size_type shard, const T& value) {
+        Shard& s = shards_[shard];
+        const sequence_type tail = s.tail.load(std::memory_order_relaxed);
+        if (tail - s.cached_head == capacity_) {
+            s.cached_head = s.head.load(std::memory_order_acquire);
+            if (tail - s.cached_head == capacity_) {
+                return false;
+            }
+        }
+        allocator_traits::construct(allocator_, slot(shard, tail), value);
+        s.tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    void push(size_type shard, const T& value) {
+        while (!try_push(shard, value)) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Consumer side. Visits every shard once, starting one shard further
+    // along on each call, and passes up to batch elements from each to
+    // f(T&). A finite batch keeps a busy producer from starving the rest.
+    // Returns the number of elements consumed.
+    template <typename F>
+    size_type poll(F&& f, size_type batch = kUnbounded) {
+        return poll_shards(0, batch, f);
+    }
+
+    // Like poll(), but skips shards holding fewer than watermark elements,
+    // so that quiet producers are drained less often and in larger batches.
+    template <typename F>
+    size_type poll_watermark(size_type watermark, F&& f,
+                             size_type batch = kUnbounded) {
+        return poll_shards(watermark, batch, f);
+    }
+
+    // Consumes every element published when the call starts in increasing
+    // key(const T&) order, assuming each producer pushes in that order
+    // (timestamps, for example). Returns the number of elements consumed.
+    template <typename Key, typename F>
+    size_type poll_merged(Key&& key, F&& f) {
+        std::unique_ptr<sequence_type[]> ends(
+            new sequence_type[shard_count_]);
+        for (size_type s = 0; s < shard_count_; ++s) {
+            ends[s] = shards_[s].tail.load(std::memory_order_acquire);
+        }
+
+        size_type consumed = 0;
+        for (;;) {
+            size_type best = shard_count_;
+            for (size_type s = 0; s < shard_count_; ++s) {
+                const sequence_type head =
+                    shards_[s].head.load(std::memory_order_relaxed);
+                if (head != ends[s] &&
+                    (best == shard_count_ ||
+                     key(*slot(s, head)) < key(*front(best)))) {
+                    best = s;
+                }
+            }
+            if (best == shard_count_) {
+                return consumed;
+            }
+            consume(best, 1, f);
+            ++consumed;
+        }
+    }
+
+    // Approximate while producers or the consumer are running.
+    size_type size(size_type shard) const noexcept {
+        const Shard& s = shards_[shard];
+        return static_cast<size_type>(
+            s.tail.load(std::memory_order_acquire) -
+            s.head.load(std::memory_order_acquire));
+    }
+
+    size_type shards() const noexcept { return shard_count_; }
+
+    size_type capacity() const noexcept { return capacity_; }
+
+   private:
+    static constexpr size_type kCacheLine = 64;
+
+    struct alignas(kCacheLine) Shard {
+        // Written by the producer.
+        alignas(kCacheLine) std::atomic<sequence_type> tail{0};
+        sequence_type cached_head = 0;
+        // Written by the consumer.
+        alignas(kCacheLine) std::atomic<sequence_type> head{0};
+    };
+
+    allocator_type allocator_;
+    size_type shard_count_;
+    size_type capacity_;
+    // Slots per shard plus a cache line of padding between shards.
+    size_type stride_;
+    std::unique_ptr<Shard[]> shards_;
+    pointer slots_ = nullptr;
+    size_type next_shard_ = 0;
+
+    pointer slot(size_type shard, sequence_type seq) const noexcept {
+        return slots_ + shard * stride_ + seq % capacity_;
+    }
+
+    pointer front(size_type shard) const noexcept {
+        return slot(shard, shards_[shard].head.load(std::memory_order_relaxed));
+    }
+
+    template <typename F>
+    size_type poll_shards(size_type watermark, size_type batch, F& f) {
+        size_type consumed = 0;
+        const size_type first = next_shard_;
+        next_shard_ = next_shard_ + 1 == shard_count_ ? 0 : next_shard_ + 1;
+        for (size_type i = 0; i < shard_count_; ++i) {
+            const size_type s =
+                first + i < shard_count_ ? first + i : first + i - shard_count_;
+            const size_type available = size(s);
+            if (available == 0 || available < watermark) {
+                continue;
+            }
+            consumed += consume(s, available < batch ? available : batch, f);
+        }
+        return consumed;
+    }
+
+    template <typename F>
+    size_type consume(size_type shard, size_type n, F& f) {
+        Shard& s = shards_[shard];
+        const sequence_type head = s.head.load(std::memory_order_relaxed);
+        for (sequence_type seq = head; seq != head + n; ++seq) {
+            pointer p = slot(shard, seq);
+            try {
+                f(*p);
+            } catch (...) {
+                // The element that threw counts as consumed.
+                allocator_traits::destroy(allocator_, p);
+                s.head.store(seq + 1, std::memory_order_release);
+                throw;
+            }
+            allocator_traits::destroy(allocator_, p);
+        }
+        s.head.store(head + n, std::memory_order_release);
+        return n;
+    }
+};
@@ -0,0 +1,497 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CIRCULAR_BUFFER_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+// Reductions and transforms over the (at most two) contiguous storage
+// segments of CircularBuffer / CircularBufferExt. float and int32_t use
+// AVX2 or SSE4.1 kernels picked at runtime, everything else goes through
+// the scalar loops.
+namespace simd {
+
+enum class Level { kScalar, kSse41, kAvx2 };
+
+inline Level detect_level() noexcept {
+#ifdef CIRCULAR_BUFFER_SIMD_X86
+    static const Level level = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return Level::kAvx2;
+        }
+        if (__builtin_cpu_supports("sse4.1")) {
+            return Level::kSse41;
+        }
+        return Level::kScalar;
+    }();
+    return level;
+#else
+    return Level::kScalar;
+#endif
+}
+
+namespace detail {
+
+// A level above what the CPU supports would fault with SIGILL, so
+// requested levels are lowered to detect_level().
+inline Level usable(Level level) noexcept {
+    return std::min(level, detect_level());
+}
+
+template <typename T>
+inline constexpr bool kHasKernels =
+    std::is_same_v<T, float> || std::is_same_v<T, std::int32_t>;
+
+template <typename T>
+T sum_scalar(const T* p, std::size_t n) noexcept {
+    T result = T();
+    for (std::size_t i = 0; i < n; ++i) {
+        result += p[i];
+    }
+    return result;
+}
+
+template <typename T>
+T dot_scalar(const T* p, const T* q, std::size_t n) noexcept {
+    T result = T();
+    for (std::size_t i = 0; i < n; ++i) {
+        result += p[i] * q[i];
+    }
+    return result;
+}
+
+template <typename T>
+T min_scalar(const T* p, std::size_t n) noexcept {
+    T result = p[0];
+    for (std::size_t i = 1; i < n; ++i) {
+        result = p[i] < result ? p[i] : result;
+    }
+    return result;
+}
+
+template <typename T>
+T max_scalar(const T* p, std::size_t n) noexcept {
+    T result = p[0];
+    for (std::size_t i = 1; i < n; ++i) {
+        result = result < p[i] ? p[i] : result;
+    }
+    return result;
+}
+
+template <typename T>
+void scale_scalar(T* p, std::size_t n, T factor) noexcept {
+    for (std::size_t i = 0; i < n; ++i) {
+        p[i] *= factor;
+    }
+}
+
+#ifdef CIRCULAR_BUFFER_SIMD_X86
+
+__attribute__((target("avx2"))) inline float sum_avx2(const float* p,
+                                                      std::size_t n) {
+    __m256 acc = _mm256_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm256_add_ps(acc, _mm256_loadu_ps(p + i));
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, acc);
+    float result = sum_scalar(lanes, 8);
+    return result + sum_scalar(p + i, n - i);
+}
+
+__attribute__((target("avx2"))) inline float dot_avx2(const float* p,
+                                                      const float* q,
+                                                      std::size_t n) {
+    __m256 acc = _mm256_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm256_add_ps(
+            acc, _mm256_mul_ps(_mm256_loadu_ps(p + i), _mm256_loadu_ps(q + i)));
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, acc);
+    float result = sum_scalar(lanes, 8);
+    return result + dot_scalar(p + i, q + i, n - i);
+}
+
+__attribute__((target("avx2"))) inline float min_avx2(const float* p,
+                                                      std::size_t n) {
+    __m256 acc = _mm256_set1_ps(p[0]);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm256_min_ps(acc, _mm256_loadu_ps(p + i));
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, acc);
+    float result = min_scalar(lanes, 8);
+    return i == n ? result : std::min(result, min_scalar(p + i, n - i));
+}
+
+__attribute__((target("avx2"))) inline float max_avx2(const float* p,
+                                                      std::size_t n) {
+    __m256 acc = _mm256_set1_ps(p[0]);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm256_max_ps(acc, _mm256_loadu_ps(p + i));
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, acc);
+    float result = max_scalar(lanes, 8);
+    return i == n ? result : std::max(result, max_scalar(p + i, n - i));
+}
+
+__attribute__((target("avx2"))) inline void scale_avx2(float* p, std::size_t n,
+                                                       float factor) {
+    const __m256 f = _mm256_set1_ps(factor);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(p + i, _mm256_mul_ps(_mm256_loadu_ps(p + i), f));
+    }
+    scale_scalar(p + i, n - i, factor);
+}
+
+__attribute__((target("avx2"))) inline std::int32_t sum_avx2(
+    const std::int32_t* p, std::size_t n) {
+    __m256i acc = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm256_add_epi32(
+            acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)));
+    }
+    alignas(32) std::int32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return sum_scalar(lanes, 8) + sum_scalar(p + i, n - i);
+}
+
+__attribute__((target("avx2"))) inline std::int32_t dot_avx2(
+    const std::int32_t* p, const std::int32_t* q, std::size_t n) {
+    __m256i acc = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm256_add_epi32(
+            acc,
+            _mm256_mullo_epi32(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)),
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(q + i))));
+    }
+    alignas(32) std::int32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return sum_scalar(lanes, 8) + dot_scalar(p + i, q + i, n - i);
+}
+
+__attribute__((target("avx2"))) inline std::int32_t min_avx2(
+    const std::int32_t* p, std::size_t n) {
+    __m256i acc = _mm256_set1_epi32(p[0]);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm256_min_epi32(
+            acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)));
+    }
+    alignas(32) std::int32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    std::int32_t result = min_scalar(lanes, 8);
+    return i == n ? result : std::min(result, min_scalar(p + i, n - i));
+}
+
+__attribute__((target("avx2"))) inline std::int32_t max_avx2(
+    const std::int32_t* p, std::size_t n) {
+    __m256i acc = _mm256_set1_epi32(p[0]);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm256_max_epi32(
+            acc, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)));
+    }
+    alignas(32) std::int32_t lanes[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    std::int32_t result = max_scalar(lanes, 8);
+    return i == n ? result : std::max(result, max_scalar(p + i, n - i));
+}
+
+__attribute__((target("avx2"))) inline void scale_avx2(std::int32_t* p,
+                                                       std::size_t n,
+                                                       std::int32_t factor) {
+    const __m256i f = _mm256_set1_epi32(factor);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        auto* slot = reinterpret_cast<__m256i*>(p + i);
+        _mm256_storeu_si256(slot,
+                            _mm256_mullo_epi32(_mm256_loadu_si256(slot), f));
+    }
+    scale_scalar(p + i, n - i, factor);
+}
+
+__attribute__((target("sse4.1"))) inline float sum_sse41(const float* p,
+                                                         std::size_t n) {
+    __m128 acc = _mm_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm_add_ps(acc, _mm_loadu_ps(p + i));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc);
+    float result = sum_scalar(lanes, 4);
+    return result + sum_scalar(p + i, n - i);
+}
+
+__attribute__((target("sse4.1"))) inline float dot_sse41(const float* p,
+                                                         const float* q,
+                                                         std::size_t n) {
+    __m128 acc = _mm_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm_add_ps(acc,
+                         _mm_mul_ps(_mm_loadu_ps(p + i), _mm_loadu_ps(q + i)));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc);
+    float result = sum_scalar(lanes, 4);
+    return result + dot_scalar(p + i, q + i, n - i);
+}
+
+__attribute__((target("sse4.1"))) inline float min_sse41(const float* p,
+                                                         std::size_t n) {
+    __m128 acc = _mm_set1_ps(p[0]);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm_min_ps(acc, _mm_loadu_ps(p + i));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc);
+    float result = min_scalar(lanes, 4);
+    return i == n ? result : std::min(result, min_scalar(p + i, n - i));
+}
+
+__attribute__((target("sse4.1"))) inline float max_sse41(const float* p,
+                                                         std::size_t n) {
+    __m128 acc = _mm_set1_ps(p[0]);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm_max_ps(acc, _mm_loadu_ps(p + i));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, acc);
+    float result = max_scalar(lanes, 4);
+    return i == n ? result : std::max(result, max_scalar(p + i, n - i));
+}
+
+__attribute__((target("sse4.1"))) inline void scale_sse41(float* p,
+                                                          std::size_t n,
+                                                          float factor) {
+    const __m128 f = _mm_set1_ps(factor);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(p + i, _mm_mul_ps(_mm_loadu_ps(p + i), f));
+    }
+    scale_scalar(p + i, n - i, factor);
+}
+
+__attribute__((target("sse4.1"))) inline std::int32_t sum_sse41(
+    const std::int32_t* p, std::size_t n) {
+    __m128i acc = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm_add_epi32(
+            acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)));
+    }
+    alignas(16) std::int32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return sum_scalar(lanes, 4) + sum_scalar(p + i, n - i);
+}
+
+__attribute__((target("sse4.1"))) inline std::int32_t dot_sse41(
+    const std::int32_t* p, const std::int32_t* q, std::size_t n) {
+    __m128i acc = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm_add_epi32(
+            acc, _mm_mullo_epi32(
+                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)),
+                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(q + i))));
+    }
+    alignas(16) std::int32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return sum_scalar(lanes, 4) + dot_scalar(p + i, q + i, n - i);
+}
+
+__attribute__((target("sse4.1"))) inline std::int32_t min_sse41(
+    const std::int32_t* p, std::size_t n) {
+    __m128i acc = _mm_set1_epi32(p[0]);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm_min_epi32(
+            acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)));
+    }
+    alignas(16) std::int32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    std::int32_t result = min_scalar(lanes, 4);
+    return i == n ? result : std::min(result, min_scalar(p + i, n - i));
+}
+
+__attribute__((target("sse4.1"))) inline std::int32_t max_sse41(
+    const std::int32_t* p, std::size_t n) {
+    __m128i acc = _mm_set1_epi32(p[0]);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm_max_epi32(
+            acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)));
+    }
+    alignas(16) std::int32_t lanes[4];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    std::int32_t result = max_scalar(lanes, 4);
+    return i == n ? result : std::max(result, max_scalar(p + i, n - i));
+}
+
+__attribute__((target("sse4.1"))) inline void scale_sse41(std::int32_t* p,
+                                                          std::size_t n,
+                                                          std::int32_t factor) {
+    const __m128i f = _mm_set1_epi32(factor);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        auto* slot = reinterpret_cast<__m128i*>(p + i);
+        _mm_storeu_si128(slot, _mm_mullo_epi32(_mm_loadu_si128(slot), f));
+    }
+    scale_scalar(p + i, n - i, factor);
+}
+
+#endif
+
+template <typename T>
+T sum(const T* p, std::size_t n, Level level) noexcept {
+    level = usable(level);
+#ifdef CIRCULAR_BUFFER_SIMD_X86
+    if constexpr (kHasKernels<T>) {
+        if (level == Level::kAvx2) return sum_avx2(p, n);
+        if (level == Level::kSse41) return sum_sse41(p, n);
+    }
+#endif
+    return sum_scalar(p, n);
+}
+
+template <typename T>
+T dot(const T* p, const T* q, std::size_t n, Level level) noexcept {
+    level = usable(level);
+#ifdef CIRCULAR_BUFFER_SIMD_X86
+    if constexpr (kHasKernels<T>) {
+        if (level == Level::kAvx2) return dot_avx2(p, q, n);
+        if (level == Level::kSse41) return dot_sse41(p, q, n);
+    }
+#endif
+    return dot_scalar(p, q, n);
+}
+
+template <typename T>
+T min(const T* p, std::size_t n, Level level) noexcept {
+    level = usable(level);
+#ifdef CIRCULAR_BUFFER_SIMD_X86
+    if constexpr (kHasKernels<T>) {
+        if (level == Level::kAvx2) return min_avx2(p, n);
+        if (level == Level::kSse41) return min_sse41(p, n);
+    }
+#endif
+    return min_scalar(p, n);
+}
+
+template <typename T>
+T max(const T* p, std::size_t n, Level level) noexcept {
+    level = usable(level);
+#ifdef CIRCULAR_BUFFER_SIMD_X86
+    if constexpr (kHasKernels<T>) {
+        if (level == Level::kAvx2) return max_avx2(p, n);
+        if (level == Level::kSse41) return max_sse41(p, n);
+    }
+#endif
+    return max_scalar(p, n);
+}
+
+template <typename T>
+void scale(T* p, std::size_t n, T factor, Level level) noexcept {
+    level = usable(level);
+#ifdef CIRCULAR_BUFFER_SIMD_X86
+    if constexpr (kHasKernels<T>) {
+        if (level == Level::kAvx2) return scale_avx2(p, n, factor);
+        if (level == Level::kSse41) return scale_sse41(p, n, factor);
+    }
+#endif
+    scale_scalar(p, n, factor);
+}
+
+}  // namespace detail
+
+template <typename Buffer>
+typename Buffer::value_type sum(const Buffer& buffer,
+                                Level level = detect_level()) {
+    const auto first = buffer.first_segment();
+    const auto second = buffer.second_segment();
+    return detail::sum(first.data(), first.size(), level) +
+           detail::sum(second.data(), second.size(), level);
+}
+
+// Dot product of the buffer (oldest element first) against coefficients,
+// which must hold exactly size() values.
+template <typename Buffer>
+typename Buffer::value_type dot(
+    const Buffer& buffer,
+    std::span<const typename Buffer::value_type> coefficients,
+    Level level = detect_level()) {
+    const auto first = buffer.first_segment();
+    const auto second = buffer.second_segment();
+    if (coefficients.size() != first.size() + second.size()) {
+        throw std::invalid_argument(
+            "Coefficients size doesn't match buffer size");
+    }
+    return detail::dot(first.data(), coefficients.data(), first.size(),
+                       level) +
+           detail::dot(second.data(), coefficients.data() + first.size(),
+                       second.size(), level);
+}
+
+template <typename Buffer>
+typename Buffer::value_type min(const Buffer& buffer,
+                                Level level = detect_level()) {
+    const auto first = buffer.first_segment();
+    const auto second = buffer.second_segment();
+    if (first.empty()) {
+        throw std::out_of_range("Trying to get data from empty buffer");
+    }
+    auto result = detail::min(first.data(), first.size(), level);
+    if (!second.empty()) {
+        auto other = detail::min(second.data(), second.size(), level);
+        result = other < result ? other : result;
+    }
+    return result;
+}
+
+template <typename Buffer>
+typename Buffer::value_type max(const Buffer& buffer,
+                                Level level = detect_level()) {
+    const auto first = buffer.first_segment();
+    const auto second = buffer.second_segment();
+    if (first.empty()) {
+        throw std::out_of_range("Trying to get data from empty buffer");
+    }
+    auto result = detail::max(first.data(), first.size(), level);
+    if (!second.empty()) {
+        auto other = detail::max(second.data(), second.size(), level);
+        result = result < other ? other : result;
+    }
+    return result;
+}
+
+template <typename Buffer>
+void scale(Buffer& buffer, typename Buffer::value_type factor,
+           Level level = detect_level()) {
+    auto first = buffer.first_segment();
+    auto second = buffer.second_segment();
+    detail::scale(first.data(), first.size(), factor, level);
+    detail::scale(second.data(), second.size(), factor, level);
+}
+
+}  // namespace simd
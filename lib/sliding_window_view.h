@@ -0,0 +1,188 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Elements [begin, begin + width) of a ring, referenced in place. A window
+// that does not cross the end of the storage is one contiguous span;
+// otherwise it is split in two like the ring itself, so the
+// segment-aware algorithms (simd::sum, simd::dot, ...) accept it as is.
+template <typename U>
+class Window {
+   public:
+    using value_type = std::remove_const_t<U>;
+    using size_type = std::size_t;
+
+    class iterator {
+       public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::remove_const_t<U>;
+        using difference_type = std::ptrdiff_t;
+        using reference = U&;
+        using pointer = U*;
+
+        iterator() = default;
+
+        iterator(std::span<U> first, std::span<U> second, size_type index)
+            : first_(first), second_(second), index_(index) {}
+
+        U& operator*() const noexcept {
+            return index_ < first_.size() ? first_[index_]
+                                          : second_[index_ - first_.size()];
+        }
+
+        iterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        iterator operator++(int) noexcept {
+            auto old = *this;
+            ++index_;
+            return old;
+        }
+
+        bool operator==(const iterator& other) const noexcept {
+            return index_ == other.index_;
+        }
+
+       private:
+        std::span<U> first_;
+        std::span<U> second_;
+        size_type index_ = 0;
+    };
+
+    Window() = default;
+
+    Window(std::span<U> first, std::span<U> second) noexcept
+        : first_(first), second_(second) {}
+
+    bool contiguous() const noexcept { return second_.empty(); }
+
+    // The whole window; only valid when contiguous().
+    std::span<U> span() const {
+        if (!contiguous()) {
+            throw std::logic_error("Window wraps around the storage");
+        }
+        return first_;
+    }
+
+    std::span<U> first_segment() const noexcept { return first_; }
+
+    std::span<U> second_segment() const noexcept { return second_; }
+
+    size_type size() const noexcept { return first_.size() + second_.size(); }
+
+    U& operator[](size_type i) const noexcept {
+        return i < first_.size() ? first_[i] : second_[i - first_.size()];
+    }
+
+    iterator begin() const noexcept { return iterator(first_, second_, 0); }
+
+    iterator end() const noexcept {
+        return iterator(first_, second_, size());
+    }
+
+   private:
+    std::span<U> first_;
+    std::span<U> second_;
+};
+
+// Every window of width elements of a ring, the i-th one starting at
+// logical index i * step. The view refers to the storage segments as they
+// were at construction and is invalidated by anything that modifies the
+// ring's layout.
+template <typename U>
+class SlidingWindowView
+    : public std::ranges::view_interface<SlidingWindowView<U>> {
+   public:
+    using size_type = std::size_t;
+    using window_type = Window<U>;
+
+    class iterator {
+       public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Window<U>;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+
+        iterator(const SlidingWindowView* view, size_type index)
+            : view_(view), index_(index) {}
+
+        Window<U> operator*() const { return (*view_)[index_]; }
+
+        iterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        iterator operator++(int) noexcept {
+            auto old = *this;
+            ++index_;
+            return old;
+        }
+
+        bool operator==(const iterator& other) const noexcept {
+            return index_ == other.index_;
+        }
+
+       private:
+        const SlidingWindowView* view_ = nullptr;
+        size_type index_ = 0;
+    };
+
+    SlidingWindowView() = default;
+
+    SlidingWindowView(std::span<U> first, std::span<U> second,
+                      size_type width, size_type step)
+        : first_(first), second_(second), width_(width), step_(step) {
+        if (width == 0 || step == 0) {
+            throw std::invalid_argument("Window width and step must be > 0");
+        }
+    }
+
+    iterator begin() const noexcept { return iterator(this, 0); }
+
+    iterator end() const noexcept { return iterator(this, size()); }
+
+    size_type size() const noexcept {
+        const size_type n = first_.size() + second_.size();
+        return n < width_ ? 0 : (n - width_) / step_ + 1;
+    }
+
+    Window<U> operator[](size_type i) const noexcept {
+        const size_type begin = i * step_;
+        const size_type end = begin + width_;
+        if (end <= first_.size()) {
+            return Window<U>(first_.subspan(begin, width_), std::span<U>());
+        }
+        if (begin >= first_.size()) {
+            return Window<U>(second_.subspan(begin - first_.size(), width_),
+                             std::span<U>());
+        }
+        return Window<U>(first_.subspan(begin),
+                         second_.first(end - first_.size()));
+    }
+
+    size_type width() const noexcept { return width_; }
+
+    size_type step() const noexcept { return step_; }
+
+   private:
+    std::span<U> first_;
+    std::span<U> second_;
+    size_type width_ = 1;
+    size_type step_ = 1;
+};
+
+template <typename Buffer>
+auto sliding_windows(Buffer& buffer, std::size_t width, std::size_t step = 1) {
+    using U = typename decltype(buffer.first_segment())::element_type;
+    return SlidingWindowView<U>(buffer.first_segment(),
+                                buffer.second_segment(), width, step);
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+
+#if __has_include(<unistd.h>)
+#include <unistd.h>
+#define CIRCULAR_BUFFER_HAS_FD_IO 1
+#endif
+
+// Fixed-size header written in front of a buffer snapshot. Elements follow
+// immediately, oldest first.
+struct SnapshotHeader {
+    static constexpr std::uint32_t kMagic = 0x46554243;  // "CBUF"
+    static constexpr std::uint32_t kVersion = 1;
+
+    std::uint32_t magic = kMagic;
+    std::uint32_t version = kVersion;
+    std::uint64_t capacity = 0;
+    std::uint64_t size = 0;
+    std::uint64_t element_size = 0;
+
+    // Checked before anything is allocated, since the header may come from
+    // an untrusted file.
+    void validate(std::size_t expected_element_size,
+                  std::size_t max_capacity) const {
+        if (magic != kMagic) {
+            throw std::runtime_error("Not a circular buffer snapshot");
+        }
+        if (version != kVersion) {
+            throw std::runtime_error("Unsupported snapshot version");
+        }
+        if (element_size != expected_element_size) {
+            throw std::runtime_error("Snapshot element size mismatch");
+        }
+        if (size > capacity) {
+            throw std::runtime_error("Corrupted snapshot header");
+        }
+        if (capacity > max_capacity) {
+            throw std::runtime_error("Snapshot capacity exceeds max_size()");
+        }
+        if (size > std::numeric_limits<std::size_t>::max() / element_size) {
+            throw std::runtime_error("Snapshot size overflows");
+        }
+    }
+};
+
+inline void write_bytes(std::ostream& out, const void* data, std::size_t n) {
+    if (n == 0) {
+        return;
+    }
+    if (!out.write(static_cast<const char*>(data),
+                   static_cast<std::streamsize>(n))) {
+        throw std::runtime_error("Failed to write snapshot");
+    }
+}
+
+inline void read_bytes(std::istream& in, void* data, std::size_t n) {
+    if (n == 0) {
+        return;
+    }
+    if (!in.read(static_cast<char*>(data), static_cast<std::streamsize>(n))) {
+        throw std::runtime_error("Failed to read snapshot");
+    }
+}
+
+#ifdef CIRCULAR_BUFFER_HAS_FD_IO
+inline void write_bytes(int fd, const void* data, std::size_t n) {
+    auto current = static_cast<const char*>(data);
+    while (n > 0) {
+        const ssize_t written = ::write(fd, current, n);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("Failed to write snapshot");
+        }
+        current += written;
+        n -= static_cast<std::size_t>(written);
+    }
+}
+
+inline void read_bytes(int fd, void* data, std::size_t n) {
+    auto current = static_cast<char*>(data);
+    while (n > 0) {
+        const ssize_t got = ::read(fd, current, n);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            throw std::runtime_error("Failed to read snapshot");
+        }
+        current += got;
+        n -= static_cast<std::size_t>(got);
+    }
+}
+#endif
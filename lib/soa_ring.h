@@ -0,0 +1,294 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+// One storage segment pair of a single SoaRing column. Exposes the same
+// first_segment()/second_segment() interface as CircularBuffer, so the
+// segment-aware algorithms (simd::sum, simd::scale, ...) run on a column
+// directly.
+template <typename U>
+class SoaColumn {
+   public:
+    using value_type = std::remove_const_t<U>;
+    using size_type = std::size_t;
+
+    SoaColumn(std::span<U> first, std::span<U> second) noexcept
+        : first_(first), second_(second) {}
+
+    std::span<U> first_segment() const noexcept { return first_; }
+
+    std::span<U> second_segment() const noexcept { return second_; }
+
+    size_type size() const noexcept { return first_.size() + second_.size(); }
+
+    U& operator[](size_type i) const noexcept {
+        return i < first_.size() ? first_[i] : second_[i - first_.size()];
+    }
+
+   private:
+    std::span<U> first_;
+    std::span<U> second_;
+};
+
+// Fixed-capacity ring that stores every field of a row in its own parallel
+// circular array sharing one head and size. Pushing into a full ring
+// overwrites the oldest row, like CircularBuffer::push_back. If copying a
+// field throws, the ring is left unchanged; if the fields' move assignment
+// can throw, overwriting a row only offers the basic guarantee.
+template <typename... Fields>
+    requires(sizeof...(Fields) > 0)
+class SoaRing {
+   public:
+    using size_type = std::size_t;
+    using value_type = std::tuple<Fields...>;
+    using reference = std::tuple<Fields&...>;
+    using const_reference = std::tuple<const Fields&...>;
+
+    template <bool IsConst>
+    class Iterator {
+        using Ring = std::conditional_t<IsConst, const SoaRing, SoaRing>;
+
+       public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::tuple<Fields...>;
+        using difference_type = std::ptrdiff_t;
+        using reference =
+            std::conditional_t<IsConst, std::tuple<const Fields&...>,
+                               std::tuple<Fields&...>>;
+        using pointer = void;
+
+        Iterator() = default;
+
+        Iterator(Ring* ring, size_type index) : ring_(ring), index_(index) {}
+
+        reference operator*() const { return (*ring_)[index_]; }
+
+        Iterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        Iterator operator++(int) noexcept {
+            auto old = *this;
+            ++index_;
+            return old;
+        }
+
+        bool operator==(const Iterator& other) const noexcept {
+            return index_ == other.index_;
+        }
+
+        bool operator!=(const Iterator& other) const noexcept {
+            return !(*this == other);
+        }
+
+       private:
+        Ring* ring_ = nullptr;
+        size_type index_ = 0;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    explicit SoaRing(size_type capacity)
+        : capacity_(capacity), columns_(allocate_columns(capacity)) {}
+
+    SoaRing(const SoaRing&) = delete;
+    SoaRing& operator=(const SoaRing&) = delete;
+
+    ~SoaRing() {
+        clear();
+        deallocate_columns(std::index_sequence_for<Fields...>());
+    }
+
+    void push_back(const Fields&... values) {
+        if (capacity_ == 0) {
+            return;
+        }
+        const size_type slot = physical(size_);
+        if (size_ == capacity_) {
+            assign_row(slot, std::index_sequence_for<Fields...>(), values...);
+            head_ = next(head_);
+            return;
+        }
+        construct_row(slot, std::index_sequence_for<Fields...>(), values...);
+        ++size_;
+    }
+
+    void push_back(const value_type& row) {
+        std::apply([this](const Fields&... values) { push_back(values...); },
+                   row);
+    }
+
+    void pop_front() {
+        if (empty()) {
+            throw std::out_of_range(
+                "Trying to pop_front() from an empty buffer");
+        }
+        destroy_row(head_, std::index_sequence_for<Fields...>());
+        head_ = next(head_);
+        --size_;
+    }
+
+    void clear() noexcept {
+        for (size_type i = 0; i < size_; ++i) {
+            destroy_row(physical(i), std::index_sequence_for<Fields...>());
+        }
+        head_ = 0;
+        size_ = 0;
+    }
+
+    reference operator[](size_type i) noexcept {
+        return row<reference>(physical(i),
+                              std::index_sequence_for<Fields...>());
+    }
+
+    const_reference operator[](size_type i) const noexcept {
+        return row<const_reference>(physical(i),
+                                    std::index_sequence_for<Fields...>());
+    }
+
+    template <std::size_t I>
+    SoaColumn<std::tuple_element_t<I, value_type>> column() noexcept {
+        return make_column(std::get<I>(columns_));
+    }
+
+    template <std::size_t I>
+    SoaColumn<const std::tuple_element_t<I, value_type>> column()
+        const noexcept {
+        using U = const std::tuple_element_t<I, value_type>;
+        return make_column(static_cast<U*>(std::get<I>(columns_)));
+    }
+
+    iterator begin() noexcept { return iterator(this, 0); }
+
+    iterator end() noexcept { return iterator(this, size_); }
+
+    const_iterator begin() const noexcept { return const_iterator(this, 0); }
+
+    const_iterator end() const noexcept {
+        return const_iterator(this, size_);
+    }
+
+    size_type size() const noexcept { return size_; }
+
+    size_type capacity() const noexcept { return capacity_; }
+
+    bool empty() const noexcept { return size_ == 0; }
+
+   private:
+    size_type capacity_;
+    size_type head_ = 0;
+    size_type size_ = 0;
+    std::tuple<Fields*...> columns_;
+
+    template <typename U>
+    using allocator_traits = std::allocator_traits<std::allocator<U>>;
+
+    static std::tuple<Fields*...> allocate_columns(size_type capacity) {
+        std::tuple<Fields*...> columns;
+        std::size_t allocated = 0;
+        try {
+            std::apply(
+                [&](auto*&... column) {
+                    ((column = allocate_one(column, capacity), ++allocated),
+                     ...);
+                },
+                columns);
+        } catch (...) {
+            std::size_t index = 0;
+            std::apply(
+                [&](auto*... column) {
+                    ((index++ < allocated ? deallocate_one(column, capacity)
+                                          : void()),
+                     ...);
+                },
+                columns);
+            throw;
+        }
+        return columns;
+    }
+
+    template <typename U>
+    static U* allocate_one(U*, size_type capacity) {
+        std::allocator<U> allocator;
+        return allocator_traits<U>::allocate(allocator, capacity);
+    }
+
+    template <typename U>
+    static void deallocate_one(U* column, size_type capacity) noexcept {
+        std::allocator<U> allocator;
+        allocator_traits<U>::deallocate(allocator, column, capacity);
+    }
+
+    template <std::size_t... I>
+    void deallocate_columns(std::index_sequence<I...>) noexcept {
+        (deallocate_one(std::get<I>(columns_), capacity_), ...);
+    }
+
+    size_type physical(size_type i) const noexcept {
+        const size_type slot = head_ + i;
+        return slot >= capacity_ ? slot - capacity_ : slot;
+    }
+
+    size_type next(size_type slot) const noexcept {
+        return slot + 1 == capacity_ ? 0 : slot + 1;
+    }
+
+    template <std::size_t... I>
+    void construct_row(size_type slot, std::index_sequence<I...>,
+                       const Fields&... values) {
+        std::size_t constructed = 0;
+        try {
+            ((std::construct_at(std::get<I>(columns_) + slot, values),
+              ++constructed),
+             ...);
+        } catch (...) {
+            ((I < constructed ? std::destroy_at(std::get<I>(columns_) + slot)
+                              : void()),
+             ...);
+            throw;
+        }
+    }
+
+    // The new row is copied in full before the slot is touched, so a
+    // throwing copy cannot leave it half overwritten.
+    template <std::size_t... I>
+    void assign_row(size_type slot, std::index_sequence<I...>,
+                    const Fields&... values) {
+        if constexpr ((std::is_nothrow_copy_assignable_v<Fields> && ...)) {
+            ((std::get<I>(columns_)[slot] = values), ...);
+        } else {
+            value_type row(values...);
+            ((std::get<I>(columns_)[slot] = std::move(std::get<I>(row))),
+             ...);
+        }
+    }
+
+    template <std::size_t... I>
+    void destroy_row(size_type slot, std::index_sequence<I...>) noexcept {
+        (std::destroy_at(std::get<I>(columns_) + slot), ...);
+    }
+
+    template <typename Row, std::size_t... I>
+    Row row(size_type slot, std::index_sequence<I...>) const noexcept {
+        return Row(std::get<I>(columns_)[slot]...);
+    }
+
+    template <typename U>
+    SoaColumn<U> make_column(U* column) const noexcept {
+        if (head_ + size_ <= capacity_) {
+            return SoaColumn<U>(std::span<U>(column + head_, size_),
+                                std::span<U>());
+        }
+        return SoaColumn<U>(
+            std::span<U>(column + head_, capacity_ - head_),
+            std::span<U>(column, head_ + size_ - capacity_));
+    }
+};
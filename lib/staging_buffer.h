@@ -0,0 +1,188 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <span>
+#include <utility>
+
+#include "circular_buffer.h"
+#include "circular_buffer_ext.h"
+
+// Growing ring shared between threads behind a mutex. Writers either push
+// one element per lock or hand over a whole batch of staged elements with
+// push_bulk().
+template <typename T, typename Alloc = std::allocator<T>>
+class SharedRing {
+   public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    explicit SharedRing(size_type capacity = 0,
+                        const Alloc& allocator = Alloc())
+        : buffer_(capacity, allocator) {}
+
+    SharedRing(const SharedRing&) = delete;
+    SharedRing& operator=(const SharedRing&) = delete;
+
+    void push(const T& value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffer_.push_back(value);
+    }
+
+    // Appends first and then second under a single lock.
+    void push_bulk(std::span<T> first, std::span<T> second) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if constexpr (requires { buffer_.prepare(first.size()); }) {
+            const size_type n = first.size() + second.size();
+            auto [head, tail] = buffer_.prepare(n);
+            copy_into(first, second, head, tail);
+            buffer_.commit(n);
+        } else {
+            for (T& value : first) {
+                buffer_.push_back(std::move(value));
+            }
+            for (T& value : second) {
+                buffer_.push_back(std::move(value));
+            }
+        }
+    }
+
+    bool try_pop(T& out) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (buffer_.empty()) {
+            return false;
+        }
+        out = buffer_.pop_front();
+        return true;
+    }
+
+    // Passes every element to f(T&) under one lock and removes them.
+    template <typename F>
+    size_type drain(F&& f) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const size_type n = buffer_.size();
+        auto [first, second] = buffer_.peek(n);
+        for (T& value : first) {
+            f(value);
+        }
+        for (T& value : second) {
+            f(value);
+        }
+        buffer_.release(n);
+        return n;
+    }
+
+    size_type size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return buffer_.size();
+    }
+
+   private:
+    mutable std::mutex mutex_;
+    CircularBufferExt<T, Alloc> buffer_;
+
+    // Copies the two source segments into the two destination segments,
+    // which split the same number of elements at a different point.
+    static void copy_into(std::span<T> first, std::span<T> second,
+                          std::span<T> head, std::span<T> tail) {
+        std::span<T> sources[] = {first, second};
+        std::span<T> targets[] = {head, tail};
+        std::size_t target = 0;
+        std::size_t offset = 0;
+        for (std::span<T> source : sources) {
+            while (!source.empty()) {
+                while (offset == targets[target].size()) {
+                    ++target;
+                    offset = 0;
+                }
+                const std::size_t n =
+                    std::min(source.size(), targets[target].size() - offset);
+                std::memcpy(targets[target].data() + offset, source.data(),
+                            n * sizeof(T));
+                source = source.subspan(n);
+                offset += n;
+            }
+        }
+    }
+};
+
+// Write-combining front for a SharedRing, meant to be owned by one thread
+// (typically as a thread_local). push() only touches a fixed local ring;
+// the staged elements go to the shared ring in one push_bulk() once Batch
+// of them are waiting, on flush(), from the destructor (i.e. at thread exit
+// for a thread_local), and once the oldest has waited max_delay. The delay
+// is only checked by push() at batch sizes 2, 4, 8, ... and by
+// flush_if_stale(), so max_delay bounds the wait only for an owner that
+// calls flush_if_stale() when it goes idle. The shared ring must outlive
+// the staging buffer.
+template <typename T, std::size_t Batch = 64,
+          typename Alloc = std::allocator<T>>
+class StagingBuffer {
+   public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using clock = std::chrono::steady_clock;
+
+    explicit StagingBuffer(
+        SharedRing<T, Alloc>& shared,
+        clock::duration max_delay = std::chrono::milliseconds(10))
+        : shared_(shared), max_delay_(max_delay), staged_(Batch) {
+        static_assert(Batch > 0, "StagingBuffer batch must be > 0");
+    }
+
+    StagingBuffer(const StagingBuffer&) = delete;
+    StagingBuffer& operator=(const StagingBuffer&) = delete;
+
+    // A flush that throws here, e.g. because the shared ring cannot grow,
+    // calls std::terminate rather than losing the batch silently. Owners
+    // that need to recover call flush() before destruction.
+    ~StagingBuffer() { flush(); }
+
+    void push(const T& value) {
+        staged_.push_back(value);
+        const size_type n = staged_.size();
+        if (n == Batch) {
+            flush();
+            return;
+        }
+        // Reading the clock costs about as much as the rest of push(), so
+        // it is only sampled when the batch size reaches a power of two.
+        if (std::has_single_bit(n)) {
+            const auto now = clock::now();
+            if (n == 1) {
+                oldest_ = now;
+            } else if (now - oldest_ >= max_delay_) {
+                flush();
+            }
+        }
+    }
+
+    // Flushes when the oldest staged element has waited max_delay.
+    // Returns whether it did.
+    bool flush_if_stale() {
+        if (staged_.empty() || clock::now() - oldest_ < max_delay_) {
+            return false;
+        }
+        flush();
+        return true;
+    }
+
+    void flush() {
+        if (staged_.empty()) {
+            return;
+        }
+        shared_.push_bulk(staged_.first_segment(), staged_.second_segment());
+        staged_.clear();
+    }
+
+    size_type staged() const noexcept { return staged_.size(); }
+
+   private:
+    SharedRing<T, Alloc>& shared_;
+    clock::duration max_delay_;
+    clock::time_point oldest_;
+    CircularBuffer<T, Alloc> staged_;
+};
@@ -0,0 +1,121 @@
+#pragma once
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "circular_buffer_ext.h"
+
+// Events ordered by timestamp, holding only those no older than window()
+// relative to the newest one. Projection extracts the timestamp from an
+// event; timestamps must be pushed in non-decreasing order.
+template <typename T, typename Projection = std::identity,
+          typename Alloc = std::allocator<T>>
+class TimeWindowBuffer {
+   public:
+    using buffer_type = CircularBufferExt<T, Alloc>;
+
+    using value_type = T;
+    using const_reference = const T&;
+    using const_iterator = typename buffer_type::const_iterator;
+    using size_type = typename buffer_type::size_type;
+
+    using timestamp_type =
+        std::remove_cvref_t<std::invoke_result_t<Projection, const T&>>;
+    using duration_type = decltype(std::declval<timestamp_type>() -
+                                   std::declval<timestamp_type>());
+
+    explicit TimeWindowBuffer(duration_type window,
+                              Projection projection = Projection(),
+                              const Alloc& allocator = Alloc())
+        : window_(window), projection_(projection), buffer_(allocator) {}
+
+    void push(const T& event) {
+        const timestamp_type ts = timestamp(event);
+        if (!buffer_.empty() && ts < timestamp(buffer_.back())) {
+            throw std::invalid_argument(
+                "Timestamps must be pushed in non-decreasing order");
+        }
+        expire(ts);
+        buffer_.push_back(event);
+    }
+
+    // Drops every event older than now - window().
+    void expire(const timestamp_type& now) {
+        while (!buffer_.empty() &&
+               now - timestamp(buffer_.front()) > window_) {
+            buffer_.pop_front();
+        }
+    }
+
+    // First event with timestamp >= ts.
+    const_iterator lower_bound(const timestamp_type& ts) const {
+        return buffer_.nth(
+            bound(ts, [](const timestamp_type& lhs,
+                         const timestamp_type& rhs) { return lhs < rhs; }));
+    }
+
+    // First event with timestamp > ts.
+    const_iterator upper_bound(const timestamp_type& ts) const {
+        return buffer_.nth(bound(
+            ts, [](const timestamp_type& lhs, const timestamp_type& rhs) {
+                return !(rhs < lhs);
+            }));
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(
+        const timestamp_type& ts) const {
+        return {lower_bound(ts), upper_bound(ts)};
+    }
+
+    const_iterator begin() const noexcept { return buffer_.cbegin(); }
+
+    const_iterator end() const noexcept { return buffer_.cend(); }
+
+    const_reference front() const { return buffer_.front(); }
+
+    const_reference back() const { return buffer_.back(); }
+
+    size_type size() const noexcept { return buffer_.size(); }
+
+    bool empty() const noexcept { return buffer_.empty(); }
+
+    void clear() noexcept { buffer_.clear(); }
+
+    duration_type window() const noexcept { return window_; }
+
+    const buffer_type& buffer() const noexcept { return buffer_; }
+
+   private:
+    duration_type window_;
+    Projection projection_;
+    buffer_type buffer_;
+
+    timestamp_type timestamp(const T& event) const {
+        return std::invoke(projection_, event);
+    }
+
+    // Index of the first element for which before(element_ts, ts) is false.
+    // Both storage segments are sorted and every timestamp in the first one
+    // is <= every timestamp in the second, so one comparison against the
+    // end of the first segment picks the segment to search.
+    template <typename Before>
+    size_type bound(const timestamp_type& ts, Before before) const {
+        const auto first = buffer_.first_segment();
+        const auto second = buffer_.second_segment();
+        auto element_before = [&](const T& event, const timestamp_type& key) {
+            return before(timestamp(event), key);
+        };
+
+        if (!second.empty() && element_before(first.back(), ts)) {
+            return first.size() +
+                   (std::lower_bound(second.begin(), second.end(), ts,
+                                     element_before) -
+                    second.begin());
+        }
+        return std::lower_bound(first.begin(), first.end(), ts,
+                                element_before) -
+               first.begin();
+    }
+};
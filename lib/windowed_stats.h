@@ -0,0 +1,167 @@
+#pragma once
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "circular_buffer.h"
+#include "circular_buffer_ext.h"
+
+// Rolling window over CircularBuffer that keeps sum, mean, variance, min and
+// max up to date on every push instead of rescanning the whole window.
+template <typename T, typename Alloc = std::allocator<T>>
+    requires std::is_arithmetic_v<T>
+class WindowedStats {
+   public:
+    using value_type = T;
+    using const_reference = const T&;
+    using size_type = std::size_t;
+    using window_type = CircularBuffer<T, Alloc>;
+    using sum_type =
+        std::conditional_t<std::is_floating_point_v<T>, T,
+                           std::conditional_t<std::is_signed_v<T>,
+                                              std::int64_t, std::uint64_t>>;
+
+    explicit WindowedStats(size_type window, const Alloc& allocator = Alloc())
+        : window_(window, allocator) {}
+
+    void push(const T& value) {
+        if (window_.capacity() == 0) {
+            return;
+        }
+        if (window_.size() == window_.capacity()) {
+            retire(window_.front());
+        }
+        window_.push_back(value);
+        admit(value);
+    }
+
+    void clear() noexcept {
+        window_.clear();
+        min_.clear();
+        max_.clear();
+        count_ = 0;
+        oldest_seq_ = 0;
+        next_seq_ = 0;
+        sum_ = sum_type();
+        compensation_ = sum_type();
+        mean_ = 0.0;
+        m2_ = 0.0;
+    }
+
+    size_type size() const noexcept { return count_; }
+
+    size_type capacity() const noexcept { return window_.capacity(); }
+
+    bool empty() const noexcept { return count_ == 0; }
+
+    bool full() const noexcept { return count_ == window_.capacity(); }
+
+    const window_type& window() const noexcept { return window_; }
+
+    sum_type sum() const noexcept { return sum_; }
+
+    double mean() const noexcept { return mean_; }
+
+    double variance() const noexcept {
+        return count_ == 0 ? 0.0 : clamp_m2() / count_;
+    }
+
+    double sample_variance() const noexcept {
+        return count_ < 2 ? 0.0 : clamp_m2() / (count_ - 1);
+    }
+
+    const_reference min() const {
+        if (min_.empty()) {
+            throw std::out_of_range("Trying to get min of an empty window");
+        }
+        return min_.front().first;
+    }
+
+    const_reference max() const {
+        if (max_.empty()) {
+            throw std::out_of_range("Trying to get max of an empty window");
+        }
+        return max_.front().first;
+    }
+
+   private:
+    using entry = std::pair<T, std::uint64_t>;
+    using entry_alloc =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<entry>;
+
+    window_type window_;
+    // Monotonic deques of (value, sequence number): min_ is non-decreasing
+    // and max_ is non-increasing from front to back, so the extremum of the
+    // window is always at the front.
+    CircularBufferExt<entry, entry_alloc> min_;
+    CircularBufferExt<entry, entry_alloc> max_;
+
+    size_type count_ = 0;
+    std::uint64_t oldest_seq_ = 0;
+    std::uint64_t next_seq_ = 0;
+
+    sum_type sum_ = sum_type();
+    sum_type compensation_ = sum_type();
+    double mean_ = 0.0;
+    double m2_ = 0.0;
+
+    double clamp_m2() const noexcept { return m2_ < 0.0 ? 0.0 : m2_; }
+
+    void add_to_sum(sum_type value) noexcept {
+        if constexpr (std::is_floating_point_v<T>) {
+            const sum_type y = value - compensation_;
+            const sum_type t = sum_ + y;
+            compensation_ = (t - sum_) - y;
+            sum_ = t;
+        } else {
+            sum_ += value;
+        }
+    }
+
+    void admit(const T& value) {
+        const std::uint64_t seq = next_seq_++;
+
+        while (!min_.empty() && value < min_.back().first) {
+            min_.pop_back();
+        }
+        min_.push_back(entry(value, seq));
+
+        while (!max_.empty() && max_.back().first < value) {
+            max_.pop_back();
+        }
+        max_.push_back(entry(value, seq));
+
+        add_to_sum(static_cast<sum_type>(value));
+
+        ++count_;
+        const double x = static_cast<double>(value);
+        const double delta = x - mean_;
+        mean_ += delta / count_;
+        m2_ += delta * (x - mean_);
+    }
+
+    void retire(const T& value) {
+        const std::uint64_t seq = oldest_seq_++;
+
+        if (!min_.empty() && min_.front().second == seq) {
+            min_.pop_front();
+        }
+        if (!max_.empty() && max_.front().second == seq) {
+            max_.pop_front();
+        }
+
+        add_to_sum(-static_cast<sum_type>(value));
+
+        --count_;
+        if (count_ == 0) {
+            mean_ = 0.0;
+            m2_ = 0.0;
+            return;
+        }
+        const double x = static_cast<double>(value);
+        const double delta = x - mean_;
+        mean_ -= delta / count_;
+        m2_ -= delta * (x - mean_);
+    }
+};
@@ -0,0 +1,145 @@
+#pragma once
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+// Chase-Lev work-stealing deque (with the memory orderings of Le et al.,
+// "Correct and Efficient Work-Stealing for Weak Memory Models"). The owning
+// thread pushes and pops at the back without locks; any other thread may
+// steal() from the front, racing for the element with a CAS on top_. Like
+// CircularBufferExt it doubles its capacity when full: the elements are
+// copied to a new array that is then published, and the old array is kept
+// until destruction because a thief may still be reading from it.
+template <typename T>
+    requires std::is_trivially_copyable_v<T>
+class WorkStealingDeque {
+    struct Array {
+        explicit Array(std::size_t size, Array* older)
+            : capacity(size),
+              slots(new std::atomic<T>[size]),
+              previous(older) {}
+
+        ~Array() { delete[] slots; }
+
+        T get(std::int64_t i) const noexcept {
+            return slots[static_cast<std::size_t>(i) & (capacity - 1)].load(
+                std::memory_order_relaxed);
+        }
+
+        void put(std::int64_t i, T value) noexcept {
+            slots[static_cast<std::size_t>(i) & (capacity - 1)].store(
+                value, std::memory_order_relaxed);
+        }
+
+        std::size_t capacity;
+        std::atomic<T>* slots;
+        Array* previous;
+    };
+
+   public:
+    using value_type = T;
+    using size_type = std::size_t;
+
+    explicit WorkStealingDeque(size_type capacity = 64)
+        : array_(new Array(std::bit_ceil(capacity < 2 ? 2 : capacity),
+                           nullptr)) {}
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    ~WorkStealingDeque() {
+        Array* array = array_.load(std::memory_order_relaxed);
+        while (array != nullptr) {
+            delete std::exchange(array, array->previous);
+        }
+    }
+
+    // Owner thread only.
+    void push(T value) {
+        const std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        const std::int64_t t = top_.load(std::memory_order_acquire);
+        Array* array = array_.load(std::memory_order_relaxed);
+        if (b - t > static_cast<std::int64_t>(array->capacity) - 1) {
+            array = grow(array, t, b);
+        }
+        array->put(b, value);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Owner thread only. Takes the most recently pushed element.
+    std::optional<T> pop() {
+        const std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Array* array = array_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+        T value = array->get(b);
+        if (t == b) {
+            // Last element: race the thieves for it.
+            const bool won = top_.compare_exchange_strong(
+                t, t + 1, std::memory_order_seq_cst,
+                std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            if (!won) {
+                return std::nullopt;
+            }
+        }
+        return value;
+    }
+
+    // Any thread. Takes the oldest element; empty when the deque is empty
+    // or another thread won the race for it.
+    std::optional<T> steal() {
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) {
+            return std::nullopt;
+        }
+        Array* array = array_.load(std::memory_order_acquire);
+        T value = array->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1,
+                                          std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return std::nullopt;
+        }
+        return value;
+    }
+
+    // Approximate when called concurrently with the owner or thieves.
+    size_type size() const noexcept {
+        const std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        const std::int64_t t = top_.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_type>(b - t) : 0;
+    }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    size_type capacity() const noexcept {
+        return array_.load(std::memory_order_relaxed)->capacity;
+    }
+
+   private:
+    alignas(64) std::atomic<std::int64_t> top_{0};
+    alignas(64) std::atomic<std::int64_t> bottom_{0};
+    alignas(64) std::atomic<Array*> array_;
+
+    Array* grow(Array* old, std::int64_t t, std::int64_t b) {
+        auto* array = new Array(old->capacity * 2, old);
+        for (std::int64_t i = t; i < b; ++i) {
+            array->put(i, old->get(i));
+        }
+        array_.store(array, std::memory_order_release);
+        return array;
+    }
+};
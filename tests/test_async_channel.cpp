@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "lib/async_channel.h"
+
+namespace {
+
+AsyncTask produce(AsyncChannel<int>& channel, int from, int count) {
+    for (int i = from; i < from + count; ++i) {
+        const bool accepted = co_await channel.push(i);
+        EXPECT_TRUE(accepted);
+    }
+}
+
+AsyncTask square(AsyncChannel<int>& in, AsyncChannel<int>& out) {
+    while (auto value = co_await in.pop()) {
+        co_await out.push(*value * *value);
+    }
+    out.close();
+}
+
+AsyncTask consume(AsyncChannel<int>& channel, long long& sum, int& count) {
+    while (auto value = co_await channel.pop()) {
+        sum += *value;
+        ++count;
+    }
+}
+
+AsyncTask close_after(AsyncChannel<int>& channel, int n,
+                      std::atomic<int>& producers) {
+    for (int i = 0; i < n; ++i) {
+        co_await channel.push(i);
+    }
+    if (--producers == 0) {
+        channel.close();
+    }
+}
+
+}  // namespace
+
+TEST(ASYNC_CHANNEL_TEST, PIPELINE_ON_ONE_THREAD) {
+    Executor executor;
+    AsyncChannel<int> numbers(2, executor);
+    AsyncChannel<int> squares(1, executor);
+    long long sum = 0;
+    int count = 0;
+    std::atomic<int> producers = 1;
+
+    spawn(executor, consume(squares, sum, count));
+    spawn(executor, square(numbers, squares));
+    spawn(executor, close_after(numbers, 100, producers));
+    executor.run();
+
+    ASSERT_EQ(count, 100);
+    ASSERT_EQ(sum, 328350);
+}
+
+TEST(ASYNC_CHANNEL_TEST, FULL_CHANNEL_SUSPENDS_PRODUCER) {
+    Executor executor;
+    AsyncChannel<int> channel(3, executor);
+    spawn(executor, produce(channel, 0, 5));
+    executor.run();
+    ASSERT_EQ(channel.size(), 3);
+
+    long long sum = 0;
+    int count = 0;
+    spawn(executor, consume(channel, sum, count));
+    executor.run();
+    ASSERT_EQ(count, 5);
+    ASSERT_EQ(channel.size(), 0);
+
+    channel.close();
+    executor.run();
+    ASSERT_EQ(sum, 10);
+}
+
+TEST(ASYNC_CHANNEL_TEST, PUSH_AFTER_CLOSE_IS_REJECTED) {
+    Executor executor;
+    AsyncChannel<std::string> channel(1, executor);
+    channel.close();
+    bool accepted = true;
+    auto task = [](AsyncChannel<std::string>& ch, bool& ok) -> AsyncTask {
+        ok = co_await ch.push("late");
+    };
+    spawn(executor, task(channel, accepted));
+    executor.run();
+    ASSERT_FALSE(accepted);
+    ASSERT_THROW(AsyncChannel<int>(0, executor), std::invalid_argument);
+}
+
+TEST(ASYNC_CHANNEL_TEST, MANY_STAGES_SHARE_THREADS) {
+    Executor executor;
+    AsyncChannel<int> channel(4, executor);
+    long long sum = 0;
+    int count = 0;
+    std::atomic<int> producers = 8;
+
+    spawn(executor, consume(channel, sum, count));
+    for (int p = 0; p < 8; ++p) {
+        spawn(executor, close_after(channel, 1000, producers));
+    }
+    std::thread helper([&] { executor.run(); });
+    executor.run();
+    helper.join();
+    executor.run();
+
+    ASSERT_EQ(count, 8000);
+    ASSERT_EQ(sum, 8 * 999 * 1000 / 2);
+}
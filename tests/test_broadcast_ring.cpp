@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lib/broadcast_ring.h"
+
+TEST(BROADCAST_RING_TEST, EVERY_CONSUMER_SEES_EVERY_ELEMENT) {
+    BroadcastRing<std::string> ring(4, 2);
+    const auto logger = ring.add_consumer();
+    const auto metrics = ring.add_consumer();
+
+    ring.push("Max");
+    ring.push("Maxa");
+
+    std::string value;
+    ASSERT_TRUE(ring.try_pop(logger, value));
+    ASSERT_EQ(value, "Max");
+    ASSERT_TRUE(ring.try_pop(logger, value));
+    ASSERT_EQ(value, "Maxa");
+    ASSERT_FALSE(ring.try_pop(logger, value));
+
+    ASSERT_TRUE(ring.try_consume(
+        metrics, [](const std::string& s) { ASSERT_EQ(s, "Max"); }));
+}
+
+TEST(BROADCAST_RING_TEST, BLOCK_ON_SLOWEST_CONSUMER) {
+    BroadcastRing<int> ring(2, 2);
+    const auto fast = ring.add_consumer();
+    const auto slow = ring.add_consumer();
+
+    ASSERT_TRUE(ring.try_push(1));
+    ASSERT_TRUE(ring.try_push(2));
+
+    int value = 0;
+    ring.try_pop(fast, value);
+    ring.try_pop(fast, value);
+    ASSERT_FALSE(ring.try_push(3));
+
+    ring.try_pop(slow, value);
+    ASSERT_TRUE(ring.try_push(3));
+
+    ring.remove_consumer(slow);
+    ring.try_pop(fast, value);
+    ASSERT_TRUE(ring.try_push(4));
+}
+
+TEST(BROADCAST_RING_TEST, OVERWRITE_SKIPS_LAGGING_CONSUMER) {
+    BroadcastRing<int, BroadcastPolicy::kOverwrite> ring(4, 1);
+    const auto reader = ring.add_consumer();
+
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(ring.try_push(i));
+    }
+
+    int value = 0;
+    ASSERT_TRUE(ring.try_pop(reader, value));
+    ASSERT_EQ(value, 6);
+    ASSERT_EQ(ring.lost(reader), 6);
+}
+
+TEST(BROADCAST_RING_TEST, CONCURRENT_CONSUMERS) {
+    const int count = 100000;
+    const int consumers = 3;
+    BroadcastRing<int> ring(64, consumers);
+    std::vector<std::size_t> ids;
+    for (int i = 0; i < consumers; ++i) {
+        ids.push_back(ring.add_consumer());
+    }
+
+    // vector<bool> packs flags into shared words, so each thread keeps its
+    // results locally and stores them into its own char once done.
+    std::vector<long long> sums(consumers, 0);
+    std::vector<char> ordered(consumers, false);
+    std::vector<std::thread> threads;
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&, c] {
+            int expected = 0;
+            long long sum = 0;
+            bool in_order = true;
+            while (expected < count) {
+                ring.try_consume(ids[c], [&](const int& value) {
+                    in_order = in_order && value == expected;
+                    sum += value;
+                    ++expected;
+                });
+            }
+            sums[c] = sum;
+            ordered[c] = in_order;
+        });
+    }
+    for (int i = 0; i < count; ++i) {
+        ring.push(i);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int c = 0; c < consumers; ++c) {
+        ASSERT_TRUE(ordered[c]);
+        ASSERT_EQ(sums[c], 1LL * count * (count - 1) / 2);
+    }
+}
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "lib/circular_buffer.h"
+#include "lib/circular_buffer_ext.h"
+
+TEST(BUFFER_STATS_TEST, NO_STATS_BY_DEFAULT) {
+    CircularBuffer<int> cb(2);
+    cb.push_back(1);
+    cb.push_back(2);
+    cb.push_back(3);
+
+    ASSERT_EQ(cb.stats().overwrites, 0);
+    ASSERT_EQ(cb.stats().high_water_mark, 0);
+    using Instrumented =
+        CircularBuffer<int, std::allocator<int>, BufferStats>;
+    static_assert(sizeof(CircularBuffer<int>) + sizeof(BufferStats) ==
+                  sizeof(Instrumented));
+}
+
+TEST(BUFFER_STATS_TEST, OVERWRITES_AND_HIGH_WATER_MARK) {
+    CircularBuffer<int, std::allocator<int>, BufferStats> cb(3);
+    for (int i = 0; i < 5; ++i) {
+        cb.push_back(i);
+    }
+    cb.pop_front();
+    cb.push_front(10);
+    cb.push_front(11);
+
+    const BufferStatsSnapshot stats = cb.stats();
+    ASSERT_EQ(stats.overwrites, 3);
+    ASSERT_EQ(stats.high_water_mark, 3);
+    ASSERT_EQ(stats.growths, 0);
+}
+
+TEST(BUFFER_STATS_TEST, EXT_GROWTHS_AND_BYTES_MOVED) {
+    CircularBufferExt<std::string, std::allocator<std::string>, BufferStats>
+        cb;
+    for (int i = 0; i < 9; ++i) {
+        cb.push_back(std::to_string(i));
+    }
+
+    const BufferStatsSnapshot stats = cb.stats();
+    ASSERT_EQ(cb.capacity(), 16);
+    ASSERT_EQ(stats.growths, 5);
+    ASSERT_EQ(stats.high_water_mark, 9);
+    ASSERT_EQ(stats.bytes_moved, (1 + 2 + 4 + 8) * sizeof(std::string));
+}
+
+TEST(BUFFER_STATS_TEST, COPY_STARTS_FRESH) {
+    CircularBufferExt<int, std::allocator<int>, BufferStats> cb = {1, 2, 3};
+    cb.push_back(4);
+    auto copy = cb;
+    cb.reset_stats();
+
+    ASSERT_EQ(cb.stats().high_water_mark, 0);
+    ASSERT_EQ(copy.stats().growths, 0);
+    ASSERT_EQ(copy.stats().high_water_mark, 4);
+}
@@ -112,6 +112,20 @@ TEST(AT_TEST, AT_TAKE_MORE) {
     }
 }
 
+TEST(AT_TEST, INDEXING_ACROSS_THE_WRAP) {
+    CircularBuffer<int> cb(5);
+    for (int i = 0; i < 8; ++i) {
+        cb.push_back(i);
+    }
+    for (std::size_t i = 0; i < cb.size(); ++i) {
+        ASSERT_EQ(cb[i], static_cast<int>(i) + 3);
+        ASSERT_EQ(cb.at(i), *(cb.begin() + static_cast<int>(i)));
+    }
+    cb.at(4) = 42;
+    ASSERT_EQ(cb.back(), 42);
+    ASSERT_THROW(cb.at(5), std::out_of_range);
+}
+
 TEST(ASSIGN_TEST, N_VALUES) {
     CircularBuffer<int> cb;
     cb.assign(3, 666);
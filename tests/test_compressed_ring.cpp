@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "lib/compressed_ring.h"
+
+namespace {
+
+template <typename T>
+std::vector<T> collect(const CompressedRing<T>& ring) {
+    std::vector<T> result;
+    for (auto it = ring.begin(); it != ring.end(); ++it) {
+        result.push_back(*it);
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST(COMPRESSED_RING_TEST, EMPTY) {
+    CompressedRing<double> ring(16, 4);
+
+    ASSERT_TRUE(ring.empty());
+    ASSERT_TRUE(ring.begin() == ring.end());
+}
+
+TEST(COMPRESSED_RING_TEST, DOUBLE_ROUND_TRIP) {
+    CompressedRing<double> ring(64, 16);
+    std::vector<double> values = {0.0,
+                                  -0.0,
+                                  1.5,
+                                  1.5,
+                                  1.25,
+                                  std::numeric_limits<double>::infinity(),
+                                  -1e300,
+                                  3.14159,
+                                  std::numeric_limits<double>::denorm_min()};
+    for (double value : values) {
+        ring.push_back(value);
+    }
+
+    const std::vector<double> decoded = collect(ring);
+    ASSERT_EQ(decoded.size(), values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        ASSERT_EQ(std::signbit(decoded[i]), std::signbit(values[i]));
+        ASSERT_EQ(decoded[i], values[i]);
+    }
+}
+
+TEST(COMPRESSED_RING_TEST, INT64_ROUND_TRIP) {
+    CompressedRing<std::int64_t> ring(64, 8);
+    std::vector<std::int64_t> values = {
+        0,    10,   20,   30,   31,  -500, 100000,
+        std::numeric_limits<std::int64_t>::min(),
+        std::numeric_limits<std::int64_t>::max(),
+        42,   42,   42};
+    for (auto value : values) {
+        ring.push_back(value);
+    }
+
+    ASSERT_EQ(collect(ring), values);
+}
+
+TEST(COMPRESSED_RING_TEST, EVICTS_WHOLE_BLOCKS) {
+    CompressedRing<int> ring(8, 4);
+    for (int i = 0; i < 15; ++i) {
+        ring.push_back(i * i);
+    }
+
+    // Two sealed blocks (4..11) plus the open block (12..14).
+    ASSERT_EQ(ring.size(), 11);
+    std::vector<int> expected;
+    for (int i = 4; i < 15; ++i) {
+        expected.push_back(i * i);
+    }
+    ASSERT_EQ(collect(ring), expected);
+}
+
+TEST(COMPRESSED_RING_TEST, SLOWLY_CHANGING_SERIES_COMPRESSES) {
+    const std::size_t n = 4096;
+    CompressedRing<double> prices(n);
+    CompressedRing<std::int64_t> timestamps(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        prices.push_back(100.0 + static_cast<double>((i / 64) % 8) * 0.25);
+        timestamps.push_back(1700000000000 + static_cast<std::int64_t>(i) * 1000);
+    }
+
+    ASSERT_LT(prices.memory_usage() * 4, n * sizeof(double));
+    ASSERT_LT(timestamps.memory_usage() * 10, n * sizeof(std::int64_t));
+
+    std::size_t i = 0;
+    for (auto it = timestamps.begin(); it != timestamps.end(); ++it, ++i) {
+        ASSERT_EQ(*it, 1700000000000 + static_cast<std::int64_t>(i) * 1000);
+    }
+    ASSERT_EQ(i, n);
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "lib/circular_buffer.h"
+#include "lib/circular_buffer_ext.h"
+
+namespace {
+
+// Move constructor that may throw, which forces the copying fallback.
+struct ThrowingMove {
+    int value = 0;
+
+    ThrowingMove(int v) : value(v) {}
+    ThrowingMove(const ThrowingMove&) = default;
+    ThrowingMove(ThrowingMove&& other) noexcept(false) : value(other.value) {}
+    ThrowingMove& operator=(const ThrowingMove&) = default;
+};
+
+template <typename Buffer, typename Make>
+void check_all_rotations(std::size_t capacity, std::size_t size, Make make) {
+    for (std::size_t offset = 0; offset <= capacity; ++offset) {
+        Buffer cb(capacity);
+        for (std::size_t i = 0; i < offset; ++i) {
+            cb.push_back(make(0));
+            cb.pop_front();
+        }
+        for (std::size_t i = 0; i < size; ++i) {
+            cb.push_back(make(i));
+        }
+
+        const auto span = cb.linearize();
+        ASSERT_TRUE(cb.is_linearized());
+        ASSERT_EQ(span.size(), size);
+        ASSERT_EQ(cb.capacity(), capacity);
+        for (std::size_t i = 0; i < size; ++i) {
+            ASSERT_EQ(span[i], make(i)) << "offset " << offset;
+        }
+        cb.push_back(make(size));
+        ASSERT_EQ(cb.back(), make(size));
+    }
+}
+
+}  // namespace
+
+TEST(LINEARIZE_TEST, ALREADY_LINEAR_IS_NOT_MOVED) {
+    CircularBuffer<int> cb(4);
+    cb.push_back(1);
+    cb.push_back(2);
+    cb.pop_front();
+    ASSERT_TRUE(cb.is_linearized());
+    const int* front = &cb.front();
+    ASSERT_EQ(cb.linearize().data(), front);
+}
+
+TEST(LINEARIZE_TEST, TRIVIALLY_COPYABLE) {
+    auto make = [](std::size_t i) { return static_cast<int>(i) * 7; };
+    check_all_rotations<CircularBuffer<int>>(7, 7, make);
+    check_all_rotations<CircularBuffer<int>>(9, 4, make);
+}
+
+TEST(LINEARIZE_TEST, NON_TRIVIAL_CYCLE_ROTATION) {
+    auto make = [](std::size_t i) { return std::string(20, 'a' + i % 26); };
+    check_all_rotations<CircularBuffer<std::string>>(7, 7, make);
+    check_all_rotations<CircularBuffer<std::string>>(11, 6, make);
+    check_all_rotations<CircularBufferExt<std::string>>(5, 5, make);
+}
+
+TEST(LINEARIZE_TEST, THROWING_MOVE_COPIES) {
+    auto make = [](std::size_t i) {
+        return ThrowingMove(static_cast<int>(i));
+    };
+    CircularBuffer<ThrowingMove> cb(3);
+    for (int i = 0; i < 5; ++i) {
+        cb.push_back(make(i));
+    }
+    const auto span = cb.linearize();
+    ASSERT_EQ(span[0].value, 2);
+    ASSERT_EQ(span[2].value, 4);
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "lib/message_ring.h"
+
+namespace {
+
+struct Order {
+    std::uint64_t id;
+    double price;
+    std::string symbol;
+};
+
+struct Cancel {
+    std::uint64_t id;
+};
+
+struct Heartbeat {};
+
+struct alignas(64) Wide {
+    int value;
+};
+
+struct Throws {
+    explicit Throws(bool fail) {
+        if (fail) {
+            throw std::runtime_error("constructor failed");
+        }
+    }
+};
+
+struct Counted {
+    static inline int alive = 0;
+
+    Counted() { ++alive; }
+    ~Counted() { --alive; }
+};
+
+}  // namespace
+
+TEST(MESSAGE_RING_TEST, VISITS_EACH_TYPE_IN_ORDER) {
+    MessageRing<Order, Cancel, Heartbeat> ring(256);
+    ASSERT_TRUE(ring.emplace<Order>(Order{7, 101.5, "ACME"}));
+    ASSERT_TRUE(ring.emplace<Heartbeat>());
+    ASSERT_TRUE(ring.emplace<Cancel>(Cancel{7}));
+    ASSERT_EQ(ring.size(), 3);
+
+    std::string log;
+    struct Visitor {
+        std::string& log;
+        void operator()(Order& o) { log += "order:" + o.symbol + ";"; }
+        void operator()(Cancel& c) { log += "cancel:" + std::to_string(c.id); }
+        void operator()(Heartbeat&) { log += "hb;"; }
+    };
+    ASSERT_EQ(ring.visit_all(Visitor{log}), 3);
+    ASSERT_EQ(log, "order:ACME;hb;cancel:7");
+    ASSERT_TRUE(ring.empty());
+    ASSERT_FALSE(ring.visit(Visitor{log}));
+}
+
+TEST(MESSAGE_RING_TEST, SMALL_MESSAGES_TAKE_LITTLE_ROOM) {
+    MessageRing<Order, Cancel> ring(1024);
+    ring.emplace<Cancel>(Cancel{1});
+    ASSERT_EQ(ring.bytes_used(), 8 + 8 + 8);
+    ASSERT_LT(ring.bytes_used(), sizeof(Order));
+}
+
+TEST(MESSAGE_RING_TEST, OVER_ALIGNED_TYPES) {
+    MessageRing<Cancel, Wide> ring(1024);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_TRUE(ring.emplace<Cancel>(Cancel{0}));
+        ASSERT_TRUE(ring.emplace<Wide>(Wide{i}));
+        ring.visit([](auto&) {});
+    }
+    // Ten visits took the first five of each type.
+    int next = 5;
+    ring.visit_all([&next](auto& message) {
+        if constexpr (std::is_same_v<std::decay_t<decltype(message)>, Wide>) {
+            ASSERT_EQ(reinterpret_cast<std::uintptr_t>(&message) % 64, 0);
+            ASSERT_EQ(message.value, next++);
+        }
+    });
+    ASSERT_EQ(next, 10);
+}
+
+TEST(MESSAGE_RING_TEST, FULL_RING_REJECTS) {
+    MessageRing<Cancel> ring(48);
+    ASSERT_TRUE(ring.emplace<Cancel>(Cancel{1}));
+    ASSERT_TRUE(ring.emplace<Cancel>(Cancel{2}));
+    ASSERT_FALSE(ring.emplace<Cancel>(Cancel{3}));
+    ring.visit([](Cancel& c) { ASSERT_EQ(c.id, 1); });
+    ASSERT_TRUE(ring.emplace<Cancel>(Cancel{3}));
+}
+
+TEST(MESSAGE_RING_TEST, DESTROYS_AFTER_VISIT_AND_ON_DESTRUCTION) {
+    {
+        MessageRing<Counted, Throws> ring(256);
+        ring.emplace<Counted>();
+        ring.emplace<Counted>();
+        ASSERT_THROW(ring.emplace<Throws>(true), std::runtime_error);
+        ring.emplace<Counted>();
+        ASSERT_EQ(Counted::alive, 3);
+
+        ASSERT_THROW(ring.visit([](auto&) { throw std::logic_error("x"); }),
+                     std::logic_error);
+        ASSERT_EQ(Counted::alive, 2);
+        ASSERT_EQ(ring.visit_all([](auto&) {}), 2);
+        ASSERT_EQ(Counted::alive, 0);
+
+        ring.emplace<Counted>();
+        ring.emplace<Counted>();
+    }
+    ASSERT_EQ(Counted::alive, 0);
+}
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "lib/circular_buffer.h"
+#include "lib/circular_buffer_ext.h"
+#include "lib/parallel_algorithms.h"
+
+namespace {
+
+// Wrapped ring large enough to be split into several chunks.
+CircularBuffer<std::int64_t> make_ring() {
+    CircularBuffer<std::int64_t> cb(100'000);
+    std::uint32_t lcg = 7;
+    for (int i = 0; i < 130'000; ++i) {
+        lcg = lcg * 1664525u + 1013904223u;
+        cb.push_back(static_cast<std::int64_t>(lcg % 1000) - 500);
+    }
+    return cb;
+}
+
+}  // namespace
+
+TEST(PARALLEL_TEST, REDUCE_AND_COUNT_MATCH_SEQUENTIAL) {
+    parallel::ThreadPool pool(4);
+    const auto cb = make_ring();
+    ASSERT_FALSE(cb.second_segment().empty());
+
+    ASSERT_EQ(parallel::reduce(cb, std::int64_t{10}, std::plus<>(), pool),
+              std::accumulate(cb.begin(), cb.end(), std::int64_t{10}));
+    auto negative = [](std::int64_t x) { return x < 0; };
+    ASSERT_EQ(parallel::count_if(cb, negative, pool),
+              static_cast<std::size_t>(
+                  std::count_if(cb.begin(), cb.end(), negative)));
+}
+
+TEST(PARALLEL_TEST, FOR_EACH_AND_TRANSFORM_KEEP_ORDER) {
+    parallel::ThreadPool pool(4);
+    auto cb = make_ring();
+    std::vector<std::int64_t> expected(cb.begin(), cb.end());
+
+    parallel::for_each(cb, [](std::int64_t& x) { x *= 3; }, pool);
+    std::vector<std::int64_t> out(cb.size());
+    auto last = parallel::transform(
+        cb, out.begin(), [](std::int64_t x) { return x + 1; }, pool);
+
+    ASSERT_EQ(last, out.end());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ(out[i], expected[i] * 3 + 1);
+    }
+}
+
+TEST(PARALLEL_TEST, SORT_MATCHES_STD_SORT) {
+    parallel::ThreadPool pool(3);
+    auto cb = make_ring();
+    std::vector<std::int64_t> expected(cb.begin(), cb.end());
+    std::sort(expected.begin(), expected.end(), std::greater<>());
+
+    parallel::sort(cb, std::greater<>(), pool);
+    ASSERT_TRUE(std::equal(cb.begin(), cb.end(), expected.begin()));
+
+    CircularBufferExt<int> small = {3, 1, 2};
+    parallel::sort(small, std::less<>(), pool);
+    ASSERT_EQ(small, CircularBufferExt<int>({1, 2, 3}));
+}
+
+TEST(PARALLEL_TEST, EXCEPTION_IS_RETHROWN) {
+    parallel::ThreadPool pool(2);
+    auto cb = make_ring();
+    ASSERT_THROW(parallel::for_each(
+                     cb,
+                     [](std::int64_t x) {
+                         if (x == 499) {
+                             throw std::runtime_error("boom");
+                         }
+                     },
+                     pool),
+                 std::runtime_error);
+}
+
+TEST(PARALLEL_TEST, NESTED_CALLS_DO_NOT_DEADLOCK) {
+    parallel::ThreadPool pool(2);
+    CircularBuffer<std::int64_t> outer(1 << 16);
+    for (int i = 0; i < (1 << 16); ++i) {
+        outer.push_back(i);
+    }
+    const auto inner = make_ring();
+    const auto negative = static_cast<std::size_t>(std::count_if(
+        inner.begin(), inner.end(), [](std::int64_t x) { return x < 0; }));
+
+    std::atomic<std::size_t> mismatches = 0;
+    parallel::for_each(
+        outer,
+        [&](std::int64_t x) {
+            if (x % 4096 != 0) {
+                return;
+            }
+            const auto n = parallel::count_if(
+                inner, [](std::int64_t y) { return y < 0; }, pool);
+            mismatches += n != negative;
+        },
+        pool);
+    ASSERT_EQ(mismatches.load(), 0);
+}
+
+TEST(PARALLEL_TEST, SORT_WITHOUT_DEFAULT_CONSTRUCTOR) {
+    struct Key {
+        explicit Key(std::int64_t v) : value(v) {}
+        std::int64_t value;
+    };
+    parallel::ThreadPool pool(3);
+    const auto source = make_ring();
+    CircularBufferExt<Key> cb;
+    for (const auto x : source) {
+        cb.push_back(Key(x));
+    }
+    std::vector<std::int64_t> expected(source.begin(), source.end());
+    std::sort(expected.begin(), expected.end());
+
+    parallel::sort(
+        cb, [](const Key& a, const Key& b) { return a.value < b.value; },
+        pool);
+    ASSERT_EQ(cb.size(), expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_EQ(cb[i].value, expected[i]);
+    }
+}
+
+TEST(PARALLEL_TEST, THROWING_COMPARE_KEEPS_ELEMENTS) {
+    parallel::ThreadPool pool(3);
+    CircularBufferExt<std::string> cb;
+    const auto source = make_ring();
+    for (const auto x : source) {
+        cb.push_back(std::to_string(x));
+    }
+    std::vector<std::string> expected(cb.begin(), cb.end());
+    std::sort(expected.begin(), expected.end());
+
+    // The first comparison of a chunk sort only picks a pivot, so throwing
+    // there strands no element in a temporary inside std::sort.
+    std::atomic<int> calls = 0;
+    auto compare = [&calls](const std::string& a, const std::string& b) {
+        if (++calls == 1) {
+            throw std::runtime_error("boom");
+        }
+        return a < b;
+    };
+    ASSERT_THROW(parallel::sort(cb, compare, pool), std::runtime_error);
+    std::vector<std::string> kept(cb.begin(), cb.end());
+    std::sort(kept.begin(), kept.end());
+    ASSERT_EQ(kept, expected);
+}
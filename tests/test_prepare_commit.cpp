@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "lib/circular_buffer.h"
+#include "lib/circular_buffer_ext.h"
+
+TEST(PREPARE_COMMIT_TEST, WRITES_IN_PLACE_ACROSS_THE_WRAP) {
+    CircularBuffer<char> cb(8);
+    for (char c : std::string("abcdef")) {
+        cb.push_back(c);
+    }
+    cb.release(5);
+    ASSERT_EQ(cb.size(), 1);
+
+    auto [first, second] = cb.prepare(6);
+    ASSERT_EQ(first.size() + second.size(), 6);
+    ASSERT_FALSE(second.empty());
+    const std::string text = "ghijkl";
+    std::memcpy(first.data(), text.data(), first.size());
+    std::memcpy(second.data(), text.data() + first.size(), second.size());
+    cb.commit(4);
+
+    ASSERT_EQ(std::string(cb.begin(), cb.end()), "fghij");
+    ASSERT_THROW(cb.prepare(4), std::out_of_range);
+    ASSERT_THROW(cb.commit(4), std::out_of_range);
+}
+
+TEST(PREPARE_COMMIT_TEST, PEEK_AND_RELEASE) {
+    CircularBuffer<int> cb(4);
+    for (int i = 0; i < 6; ++i) {
+        cb.push_back(i);
+    }
+    const auto& view = cb;
+    auto [first, second] = view.peek(3);
+    ASSERT_EQ(first.size() + second.size(), 3);
+    ASSERT_EQ(first[0], 2);
+    ASSERT_EQ(second.empty() ? first[2] : second.back(), 4);
+    ASSERT_THROW(cb.peek(5), std::out_of_range);
+
+    cb.release(3);
+    ASSERT_EQ(cb.size(), 1);
+    ASSERT_EQ(cb.front(), 5);
+    ASSERT_THROW(cb.release(2), std::out_of_range);
+}
+
+TEST(PREPARE_COMMIT_TEST, RELEASE_DESTROYS_ELEMENTS) {
+    CircularBufferExt<std::string> cb(3);
+    cb.push_back(std::string(40, 'a'));
+    cb.push_back(std::string(40, 'b'));
+    cb.push_back(std::string(40, 'c'));
+    auto [first, second] = cb.peek(2);
+    ASSERT_EQ(first[1], std::string(40, 'b'));
+    cb.release(2);
+    ASSERT_EQ(cb.size(), 1);
+    ASSERT_EQ(cb.front(), std::string(40, 'c'));
+}
+
+TEST(PREPARE_COMMIT_TEST, EXT_GROWS_TO_FIT) {
+    CircularBufferExt<int> cb(2);
+    cb.push_back(1);
+    auto [first, second] = cb.prepare(5);
+    ASSERT_GE(cb.capacity(), 6);
+    ASSERT_TRUE(second.empty());
+    for (int i = 0; i < 5; ++i) {
+        first[i] = i + 2;
+    }
+    cb.commit(5);
+    ASSERT_EQ(cb, CircularBufferExt<int>({1, 2, 3, 4, 5, 6}));
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include "lib/record_ring.h"
+
+namespace {
+
+bool write(RecordRing& ring, std::string_view text) {
+    const auto span = ring.try_write(text.size());
+    if (span.data() == nullptr) {
+        return false;
+    }
+    std::memcpy(span.data(), text.data(), text.size());
+    return true;
+}
+
+std::string as_string(std::span<const std::byte> record) {
+    return std::string(reinterpret_cast<const char*>(record.data()),
+                       record.size());
+}
+
+}  // namespace
+
+TEST(RECORD_RING_TEST, WRITE_AND_READ_IN_ORDER) {
+    RecordRing ring(64);
+    ASSERT_TRUE(write(ring, "hello"));
+    ASSERT_TRUE(write(ring, ""));
+    ASSERT_TRUE(write(ring, "a longer record"));
+    ASSERT_EQ(ring.size(), 3);
+    ASSERT_EQ(ring.bytes_used(), 16 + 8 + 24);
+
+    ASSERT_EQ(as_string(ring.read()), "hello");
+    const auto empty = ring.read();
+    ASSERT_NE(empty.data(), nullptr);
+    ASSERT_TRUE(empty.empty());
+    ASSERT_EQ(as_string(ring.read()), "a longer record");
+    ASSERT_TRUE(ring.empty());
+    ASSERT_EQ(ring.read().data(), nullptr);
+}
+
+TEST(RECORD_RING_TEST, RECORDS_NEVER_STRADDLE_THE_WRAP) {
+    RecordRing ring(64);
+    ASSERT_TRUE(write(ring, std::string(20, 'a')));  // 32 bytes
+    ASSERT_TRUE(write(ring, std::string(8, 'b')));   // 16 bytes
+    ASSERT_EQ(as_string(ring.read()), std::string(20, 'a'));
+
+    // 24 bytes do not fit in the 16 left at the end: skip to offset 0.
+    const auto span = ring.try_write(16);
+    ASSERT_NE(span.data(), nullptr);
+    std::memset(span.data(), 'c', span.size());
+    ASSERT_EQ(ring.bytes_used(), 16 + 16 + 24);
+    ASSERT_EQ(ring.try_write(1).data(), nullptr);
+
+    std::string joined;
+    for (auto record : ring) {
+        joined += as_string(record) + "|";
+    }
+    ASSERT_EQ(joined, std::string(8, 'b') + "|" + std::string(16, 'c') + "|");
+
+    ASSERT_EQ(as_string(ring.read()), std::string(8, 'b'));
+    ASSERT_EQ(as_string(ring.read()), std::string(16, 'c'));
+    ASSERT_EQ(ring.bytes_used(), 0);
+}
+
+TEST(RECORD_RING_TEST, PAYLOADS_ARE_ALIGNED) {
+    RecordRing ring(256);
+    for (std::size_t size : {1, 3, 17, 0, 9}) {
+        const auto span = ring.try_write(size);
+        ASSERT_EQ(reinterpret_cast<std::uintptr_t>(span.data()) %
+                      RecordRing::kAlignment,
+                  0);
+    }
+}
+
+TEST(RECORD_RING_TEST, STREAM_OF_MIXED_SIZES) {
+    RecordRing ring(1000);
+    std::size_t written = 0;
+    std::size_t read = 0;
+    for (int round = 0; round < 2000; ++round) {
+        const std::size_t size = (round * 37) % 200;
+        const std::string text(size, static_cast<char>('a' + round % 26));
+        while (!write(ring, text)) {
+            const auto record = ring.read();
+            ASSERT_EQ(record.size(), (read * 37) % 200);
+            if (!record.empty()) {
+                ASSERT_EQ(static_cast<char>(record[0]),
+                          static_cast<char>('a' + read % 26));
+            }
+            ++read;
+        }
+        ++written;
+        ASSERT_LE(ring.bytes_used(), ring.capacity());
+    }
+    ASSERT_EQ(read + ring.size(), written);
+}
+
+TEST(RECORD_RING_TEST, OVERSIZED_RECORD_THROWS) {
+    RecordRing ring(30);
+    ASSERT_EQ(ring.capacity(), 32);
+    ASSERT_EQ(ring.max_record_size(), 24);
+    ASSERT_NE(ring.try_write(24).data(), nullptr);
+    ASSERT_THROW(ring.try_write(25), std::invalid_argument);
+    ASSERT_THROW(RecordRing(0), std::invalid_argument);
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "lib/sharded_ring.h"
+
+TEST(SHARDED_RING_TEST, FULL_SHARD_REJECTS_ONLY_ITS_PRODUCER) {
+    ShardedRing<int> ring(2, 3);
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_TRUE(ring.try_push(0, i));
+    }
+    ASSERT_FALSE(ring.try_push(0, 3));
+    ASSERT_TRUE(ring.try_push(1, 10));
+    ASSERT_EQ(ring.size(0), 3);
+    ASSERT_EQ(ring.size(1), 1);
+    ASSERT_THROW(ShardedRing<int>(0, 4), std::invalid_argument);
+    ASSERT_THROW(ShardedRing<int>(4, 0), std::invalid_argument);
+}
+
+TEST(SHARDED_RING_TEST, BATCH_LIMIT_IS_FAIR) {
+    ShardedRing<std::string> ring(3, 8);
+    for (int i = 0; i < 8; ++i) {
+        ring.push(0, "hot");
+    }
+    ring.push(1, "a");
+    ring.push(2, "b");
+
+    std::string seen;
+    auto append = [&seen](std::string& s) { seen += s[0]; };
+    ASSERT_EQ(ring.poll(append, 2), 4);
+    ASSERT_EQ(seen, "hhab");
+    ASSERT_EQ(ring.poll(append), 6);
+    ASSERT_EQ(ring.poll(append), 0);
+}
+
+TEST(SHARDED_RING_TEST, WATERMARK_SKIPS_QUIET_SHARDS) {
+    ShardedRing<int> ring(2, 8);
+    for (int i = 0; i < 4; ++i) {
+        ring.push(0, i);
+    }
+    ring.push(1, 100);
+    int sum = 0;
+    auto add = [&sum](int v) { sum += v; };
+    ASSERT_EQ(ring.poll_watermark(4, add), 4);
+    ASSERT_EQ(sum, 6);
+    ASSERT_EQ(ring.size(1), 1);
+}
+
+TEST(SHARDED_RING_TEST, MERGED_BY_TIMESTAMP) {
+    ShardedRing<std::pair<int, char>> ring(3, 4);
+    ring.push(0, {1, 'a'});
+    ring.push(0, {5, 'e'});
+    ring.push(1, {2, 'b'});
+    ring.push(1, {6, 'f'});
+    ring.push(2, {3, 'c'});
+    ring.push(2, {4, 'd'});
+
+    std::string order;
+    const auto consumed = ring.poll_merged(
+        [](const std::pair<int, char>& e) { return e.first; },
+        [&order](std::pair<int, char>& e) { order += e.second; });
+    ASSERT_EQ(consumed, 6);
+    ASSERT_EQ(order, "abcdef");
+}
+
+TEST(SHARDED_RING_TEST, MANY_PRODUCERS_ONE_CONSUMER) {
+    constexpr int kProducers = 8;
+    constexpr int kPerProducer = 20000;
+    ShardedRing<int> ring(kProducers, 64);
+    std::atomic<int> done = 0;
+
+    std::thread producers[kProducers];
+    for (int p = 0; p < kProducers; ++p) {
+        producers[p] = std::thread([&ring, &done, p] {
+            for (int i = 0; i < kPerProducer; ++i) {
+                ring.push(p, p * kPerProducer + i);
+            }
+            ++done;
+        });
+    }
+
+    int last[kProducers];
+    std::fill(std::begin(last), std::end(last), -1);
+    long long count = 0;
+    bool ordered = true;
+    auto check = [&](int v) {
+        const int p = v / kPerProducer;
+        ordered = ordered && v % kPerProducer == last[p] + 1;
+        last[p] = v % kPerProducer;
+        ++count;
+    };
+    while (done.load() < kProducers || count < kProducers * kPerProducer) {
+        if (ring.poll(check, 16) == 0) {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    ASSERT_TRUE(ordered);
+    ASSERT_EQ(count, kProducers * kPerProducer);
+}
@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "lib/circular_buffer.h"
+#include "lib/circular_buffer_ext.h"
+#include "lib/simd_kernels.h"
+
+namespace {
+
+template <typename T>
+CircularBuffer<T> make_wrapped(std::size_t capacity, std::size_t pushes) {
+    CircularBuffer<T> cb(capacity);
+    for (std::size_t i = 0; i < pushes; ++i) {
+        cb.push_back(static_cast<T>((i * 7919) % 113) - static_cast<T>(50));
+    }
+    return cb;
+}
+
+std::vector<simd::Level> supported_levels() {
+    std::vector<simd::Level> levels = {simd::Level::kScalar};
+    if (simd::detect_level() >= simd::Level::kSse41) {
+        levels.push_back(simd::Level::kSse41);
+    }
+    if (simd::detect_level() >= simd::Level::kAvx2) {
+        levels.push_back(simd::Level::kAvx2);
+    }
+    return levels;
+}
+
+}  // namespace
+
+TEST(SIMD_TEST, SEGMENTS_COVER_BUFFER) {
+    CircularBuffer<int> cb = make_wrapped<int>(10, 23);
+
+    ASSERT_FALSE(cb.second_segment().empty());
+    ASSERT_EQ(cb.first_segment().size() + cb.second_segment().size(),
+              cb.size());
+
+    std::vector<int> joined(cb.first_segment().begin(),
+                            cb.first_segment().end());
+    joined.insert(joined.end(), cb.second_segment().begin(),
+                  cb.second_segment().end());
+    ASSERT_TRUE(cb == CircularBuffer<int>(joined.begin(), joined.end()));
+}
+
+TEST(SIMD_TEST, INT32_REDUCTIONS) {
+    CircularBuffer<std::int32_t> cb = make_wrapped<std::int32_t>(37, 100);
+    std::int32_t sum = 0;
+    std::int32_t min = cb.front();
+    std::int32_t max = cb.front();
+    for (std::int32_t value : cb) {
+        sum += value;
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+
+    for (simd::Level level : supported_levels()) {
+        ASSERT_EQ(simd::sum(cb, level), sum);
+        ASSERT_EQ(simd::min(cb, level), min);
+        ASSERT_EQ(simd::max(cb, level), max);
+    }
+}
+
+TEST(SIMD_TEST, FLOAT_DOT_PRODUCT) {
+    CircularBuffer<float> cb = make_wrapped<float>(29, 61);
+    std::vector<float> taps(cb.size());
+    for (std::size_t i = 0; i < taps.size(); ++i) {
+        taps[i] = 1.0f / static_cast<float>(i + 1);
+    }
+    float expected = 0.0f;
+    for (std::size_t i = 0; i < cb.size(); ++i) {
+        expected += cb[i] * taps[i];
+    }
+
+    for (simd::Level level : supported_levels()) {
+        ASSERT_NEAR(simd::dot(cb, std::span<const float>(taps), level),
+                    expected, 1e-3);
+    }
+}
+
+TEST(SIMD_TEST, DOT_SIZE_MISMATCH) {
+    CircularBuffer<float> cb = make_wrapped<float>(8, 8);
+    std::vector<float> taps(3);
+
+    try {
+        simd::dot(cb, std::span<const float>(taps));
+        FAIL();
+    } catch (const std::invalid_argument& err) {
+        SUCCEED();
+    }
+}
+
+TEST(SIMD_TEST, SCALE_EXT) {
+    for (simd::Level level : supported_levels()) {
+        CircularBufferExt<std::int32_t> cb = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+        cb.pop_front();
+        cb.push_back(10);
+        simd::scale(cb, 3, level);
+
+        ASSERT_TRUE(cb == CircularBufferExt<std::int32_t>(
+                              {6, 9, 12, 15, 18, 21, 24, 27, 30}));
+    }
+}
+
+TEST(SIMD_TEST, UNSUPPORTED_LEVEL_FALLS_BACK) {
+    CircularBuffer<std::int32_t> cb(40);
+    for (std::int32_t i = 0; i < 50; ++i) {
+        cb.push_back(i - 20);
+    }
+    ASSERT_EQ(simd::sum(cb, simd::Level::kAvx2),
+              simd::sum(cb, simd::Level::kScalar));
+    ASSERT_EQ(simd::max(cb, simd::Level::kAvx2), 29);
+}
+
+TEST(SIMD_TEST, MIN_OF_EMPTY) {
+    CircularBuffer<float> cb(4);
+
+    try {
+        simd::min(cb);
+        FAIL();
+    } catch (const std::out_of_range& err) {
+        SUCCEED();
+    }
+}
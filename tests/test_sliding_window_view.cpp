@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <numeric>
+#include <ranges>
+#include <stdexcept>
+
+#include "lib/circular_buffer.h"
+#include "lib/simd_kernels.h"
+#include "lib/sliding_window_view.h"
+
+namespace {
+
+CircularBuffer<int> make_wrapped() {
+    CircularBuffer<int> cb(10);
+    for (int i = 0; i < 16; ++i) {
+        cb.push_back(i);
+    }
+    return cb;
+}
+
+}  // namespace
+
+TEST(SLIDING_WINDOW_TEST, WINDOWS_MATCH_INDEXED_COPIES) {
+    const auto cb = make_wrapped();
+    for (std::size_t width = 1; width <= 11; ++width) {
+        for (std::size_t step = 1; step <= 4; ++step) {
+            const auto windows = sliding_windows(cb, width, step);
+            std::size_t count = 0;
+            for (const auto& window : windows) {
+                ASSERT_EQ(window.size(), width);
+                const std::size_t begin = count * step;
+                for (std::size_t i = 0; i < width; ++i) {
+                    ASSERT_EQ(window[i], cb[begin + i]);
+                }
+                ASSERT_TRUE(std::equal(window.begin(), window.end(),
+                                       cb.begin() + begin));
+                ++count;
+            }
+            ASSERT_EQ(count, windows.size());
+            ASSERT_EQ(count, width > 10 ? 0 : (10 - width) / step + 1);
+        }
+    }
+}
+
+TEST(SLIDING_WINDOW_TEST, NON_WRAPPING_WINDOWS_ARE_SPANS) {
+    auto cb = make_wrapped();
+    const auto first = cb.first_segment();
+    const auto windows = sliding_windows(cb, 3);
+    static_assert(std::ranges::forward_range<decltype(windows)>);
+    static_assert(std::ranges::view<std::remove_const_t<decltype(windows)>>);
+
+    ASSERT_TRUE(windows[0].contiguous());
+    ASSERT_EQ(windows[0].span().data(), first.data());
+    ASSERT_FALSE(windows[3].contiguous());
+    ASSERT_THROW(windows[3].span(), std::logic_error);
+    ASSERT_FALSE(windows[4].contiguous());
+    ASSERT_TRUE(windows[5].contiguous());
+    ASSERT_EQ(windows[5].span()[0], 11);
+
+    for (auto window : sliding_windows(cb, 2, 2)) {
+        window[0] = -window[0];
+    }
+    ASSERT_EQ(cb[0], -6);
+    ASSERT_EQ(cb[1], 7);
+}
+
+TEST(SLIDING_WINDOW_TEST, SEGMENT_ALGORITHMS_ON_WINDOWS) {
+    const auto cb = make_wrapped();
+    for (const auto& window : sliding_windows(cb, 4, 3)) {
+        ASSERT_EQ(simd::sum(window),
+                  std::accumulate(window.begin(), window.end(), 0));
+    }
+    ASSERT_THROW(sliding_windows(cb, 0), std::invalid_argument);
+}
@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+#include "lib/circular_buffer.h"
+#include "lib/circular_buffer_ext.h"
+
+namespace {
+
+struct Tick {
+    long long ts;
+    double price;
+
+    bool operator==(const Tick& other) const = default;
+};
+
+}  // namespace
+
+TEST(SNAPSHOT_TEST, ROUND_TRIP_WRAPPED) {
+    CircularBuffer<Tick> cb(4);
+    for (int i = 0; i < 7; ++i) {
+        cb.push_back({i, i * 1.5});
+    }
+    ASSERT_FALSE(cb.second_segment().empty());
+
+    std::stringstream stream;
+    cb.serialize(stream);
+
+    CircularBuffer<Tick> restored;
+    restored.deserialize(stream);
+
+    ASSERT_TRUE(restored == cb);
+    ASSERT_EQ(restored.capacity(), 4);
+    ASSERT_TRUE(restored.second_segment().empty());
+}
+
+TEST(SNAPSHOT_TEST, SAME_CAPACITY) {
+    CircularBufferExt<int> cb = {21, 15, 3, 1};
+    std::stringstream stream;
+    cb.serialize(stream);
+
+    CircularBufferExt<int> restored = {1, 2, 3, 4};
+    restored.pop_front();
+    restored.deserialize(stream);
+
+    ASSERT_TRUE(restored == cb);
+}
+
+TEST(SNAPSHOT_TEST, FILE_DESCRIPTOR) {
+    CircularBuffer<int> cb = {1, 0, 6, 10, 28};
+    std::FILE* file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+
+    cb.serialize(fileno(file));
+    std::rewind(file);
+    CircularBuffer<int> restored(2);
+    restored.deserialize(fileno(file));
+    std::fclose(file);
+
+    ASSERT_TRUE(restored == cb);
+}
+
+TEST(SNAPSHOT_TEST, ELEMENT_SIZE_MISMATCH) {
+    CircularBuffer<int> cb = {1, 2, 3};
+    std::stringstream stream;
+    cb.serialize(stream);
+
+    CircularBuffer<long long> other;
+    try {
+        other.deserialize(stream);
+        FAIL();
+    } catch (const std::runtime_error& err) {
+        SUCCEED();
+    }
+}
+
+TEST(SNAPSHOT_TEST, TRUNCATED_STREAM_KEEPS_BUFFER) {
+    CircularBuffer<int> cb = {1, 2, 3};
+    std::stringstream stream;
+    cb.serialize(stream);
+    std::string bytes = stream.str();
+    bytes.pop_back();
+    std::stringstream truncated(bytes);
+
+    CircularBuffer<int> other = {7, 8};
+    try {
+        other.deserialize(truncated);
+        FAIL();
+    } catch (const std::runtime_error& err) {
+        ASSERT_TRUE(other == CircularBuffer<int>({7, 8}));
+    }
+}
+
+TEST(SNAPSHOT_TEST, TRUNCATED_STREAM_OF_SAME_CAPACITY_KEEPS_BUFFER) {
+    CircularBuffer<int> cb = {1, 2, 3};
+    std::stringstream stream;
+    cb.serialize(stream);
+    std::string bytes = stream.str();
+    bytes.pop_back();
+    std::stringstream truncated(bytes);
+
+    CircularBuffer<int> other = {7, 8, 9};
+    ASSERT_THROW(other.deserialize(truncated), std::runtime_error);
+    ASSERT_TRUE(other == CircularBuffer<int>({7, 8, 9}));
+}
+
+TEST(SNAPSHOT_TEST, FORGED_HEADER) {
+    CircularBuffer<int> other = {7, 8};
+    auto load = [&other](std::uint64_t capacity, std::uint64_t size) {
+        SnapshotHeader header;
+        header.capacity = capacity;
+        header.size = size;
+        header.element_size = sizeof(int);
+        std::stringstream stream;
+        stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        other.deserialize(stream);
+    };
+
+    ASSERT_THROW(load(other.max_size() + 1, 0), std::runtime_error);
+    ASSERT_THROW(load(std::uint64_t{1} << 62, std::uint64_t{1} << 62),
+                 std::runtime_error);
+    ASSERT_THROW(load(4, 5), std::runtime_error);
+    ASSERT_TRUE(other == CircularBuffer<int>({7, 8}));
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "lib/simd_kernels.h"
+#include "lib/soa_ring.h"
+
+TEST(SOA_RING_TEST, ROW_WISE_PUSH_AND_ITERATION) {
+    SoaRing<std::int64_t, double, std::string> ring(4);
+    ring.push_back(1, 10.5, "Max");
+    ring.push_back({2, 11.0, "Maxa"});
+
+    ASSERT_EQ(ring.size(), 2);
+    std::int64_t ts_sum = 0;
+    for (auto [ts, price, name] : ring) {
+        ts_sum += ts;
+        name += "!";
+    }
+    ASSERT_EQ(ts_sum, 3);
+    ASSERT_EQ(std::get<2>(ring[1]), "Maxa!");
+}
+
+TEST(SOA_RING_TEST, OVERWRITE_OLDEST_ROW) {
+    SoaRing<int, float> ring(3);
+    for (int i = 0; i < 5; ++i) {
+        ring.push_back(i, i * 0.5f);
+    }
+
+    ASSERT_EQ(ring.size(), 3);
+    ASSERT_EQ(std::get<0>(ring[0]), 2);
+    ASSERT_EQ(std::get<1>(ring[2]), 2.0f);
+
+    ring.pop_front();
+    ASSERT_EQ(std::get<0>(ring[0]), 3);
+}
+
+namespace {
+
+struct FlakyCopy {
+    static inline bool fail = false;
+
+    explicit FlakyCopy(int v) : value(v) {}
+
+    FlakyCopy(const FlakyCopy& other) : value(other.value) {
+        if (fail) {
+            throw std::runtime_error("copy failed");
+        }
+    }
+
+    FlakyCopy& operator=(const FlakyCopy& other) {
+        if (fail) {
+            throw std::runtime_error("copy failed");
+        }
+        value = other.value;
+        return *this;
+    }
+
+    FlakyCopy(FlakyCopy&&) noexcept = default;
+    FlakyCopy& operator=(FlakyCopy&&) noexcept = default;
+
+    int value;
+};
+
+}  // namespace
+
+TEST(SOA_RING_TEST, THROWING_OVERWRITE_KEEPS_OLDEST_ROW) {
+    SoaRing<int, FlakyCopy> ring(2);
+    ring.push_back(1, FlakyCopy(10));
+    ring.push_back(2, FlakyCopy(20));
+
+    const FlakyCopy third(30);
+    FlakyCopy::fail = true;
+    ASSERT_THROW(ring.push_back(3, third), std::runtime_error);
+    FlakyCopy::fail = false;
+
+    ASSERT_EQ(ring.size(), 2);
+    auto [id, flaky] = ring[0];
+    ASSERT_EQ(id, 1);
+    ASSERT_EQ(flaky.value, 10);
+}
+
+TEST(SOA_RING_TEST, COLUMN_SEGMENTS) {
+    SoaRing<std::int32_t, float> ring(5);
+    for (int i = 0; i < 8; ++i) {
+        ring.push_back(i, static_cast<float>(i));
+    }
+
+    auto ids = ring.column<0>();
+    ASSERT_EQ(ids.first_segment().size(), 2);
+    ASSERT_EQ(ids.second_segment().size(), 3);
+    ASSERT_EQ(ids[0], 3);
+    ASSERT_EQ(ids[4], 7);
+}
+
+TEST(SOA_RING_TEST, SIMD_ON_COLUMN) {
+    SoaRing<std::int64_t, float, std::int32_t> ring(37);
+    for (int i = 0; i < 100; ++i) {
+        ring.push_back(i, 0.5f * i, i % 7);
+    }
+
+    std::int32_t qty = 0;
+    for (int i = 63; i < 100; ++i) {
+        qty += i % 7;
+    }
+    ASSERT_EQ(simd::sum(ring.column<2>()), qty);
+    ASSERT_EQ(simd::max(ring.column<1>()), 49.5f);
+
+    auto prices = ring.column<1>();
+    simd::scale(prices, 2.0f);
+    ASSERT_EQ(std::get<1>(ring[0]), 63.0f);
+
+    const auto& const_ring = ring;
+    ASSERT_EQ(simd::min(const_ring.column<1>()), 63.0f);
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "lib/staging_buffer.h"
+
+TEST(STAGING_BUFFER_TEST, FLUSHES_WHEN_BATCH_IS_FULL) {
+    SharedRing<int> shared;
+    StagingBuffer<int, 4> staging(shared, std::chrono::hours(1));
+    for (int i = 0; i < 3; ++i) {
+        staging.push(i);
+    }
+    ASSERT_EQ(shared.size(), 0);
+    ASSERT_EQ(staging.staged(), 3);
+    staging.push(3);
+    ASSERT_EQ(shared.size(), 4);
+    ASSERT_EQ(staging.staged(), 0);
+
+    int expected = 0;
+    shared.drain([&expected](int v) { ASSERT_EQ(v, expected++); });
+    ASSERT_EQ(expected, 4);
+    ASSERT_EQ(shared.size(), 0);
+}
+
+TEST(STAGING_BUFFER_TEST, FLUSHES_AFTER_MAX_DELAY) {
+    SharedRing<std::string> shared(2);
+    StagingBuffer<std::string, 64> staging(shared,
+                                           std::chrono::milliseconds(1));
+    staging.push("first");
+    ASSERT_EQ(shared.size(), 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    staging.push("second");
+    ASSERT_EQ(shared.size(), 2);
+
+    std::string out;
+    ASSERT_TRUE(shared.try_pop(out));
+    ASSERT_EQ(out, "first");
+}
+
+TEST(STAGING_BUFFER_TEST, FLUSH_IF_STALE_ONLY_AFTER_MAX_DELAY) {
+    SharedRing<int> shared;
+    StagingBuffer<int, 64> staging(shared, std::chrono::hours(1));
+    staging.push(0);
+    staging.push(1);
+    ASSERT_FALSE(staging.flush_if_stale());
+    ASSERT_EQ(staging.staged(), 2);
+}
+
+TEST(STAGING_BUFFER_TEST, FLUSH_IF_STALE_BETWEEN_CHECKS) {
+    // push() checks the clock at two staged elements; the delay leaves
+    // ample room for the back-to-back pushes before the sleeps.
+    SharedRing<int> shared;
+    StagingBuffer<int, 64> staging(shared, std::chrono::milliseconds(100));
+    staging.push(0);
+    staging.push(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    // Three staged elements is not a size at which push() looks at the
+    // clock, so only flush_if_stale() meets the deadline.
+    staging.push(2);
+    ASSERT_EQ(shared.size(), 0);
+    ASSERT_TRUE(staging.flush_if_stale());
+    ASSERT_EQ(shared.size(), 3);
+    ASSERT_FALSE(staging.flush_if_stale());
+
+    for (int i = 0; i < 3; ++i) {
+        staging.push(i);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    staging.push(3);
+    ASSERT_EQ(shared.size(), 7);
+    ASSERT_EQ(staging.staged(), 0);
+}
+
+TEST(STAGING_BUFFER_TEST, THREAD_EXIT_FLUSHES) {
+    constexpr int kThreads = 4;
+    constexpr int kPerThread = 1000;
+    SharedRing<int> shared(16);
+
+    std::thread threads[kThreads];
+    for (auto& thread : threads) {
+        thread = std::thread([&shared] {
+            thread_local StagingBuffer<int, 64> staging(
+                shared, std::chrono::hours(1));
+            for (int i = 1; i <= kPerThread; ++i) {
+                staging.push(i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    long long sum = 0;
+    ASSERT_EQ(shared.drain([&sum](int v) { sum += v; }),
+              kThreads * kPerThread);
+    ASSERT_EQ(sum, kThreads * kPerThread * (kPerThread + 1) / 2);
+}
@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "lib/circular_buffer.h"
+#include "lib/circular_buffer_ext.h"
+
+namespace {
+
+int allocations = 0;
+
+template <typename T>
+struct CountingAllocator : std::allocator<T> {
+    using value_type = T;
+
+    CountingAllocator() = default;
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>&) noexcept {}
+
+    template <typename U>
+    struct rebind {
+        using other = CountingAllocator<U>;
+    };
+
+    T* allocate(std::size_t n) {
+        ++allocations;
+        return std::allocator<T>::allocate(n);
+    }
+};
+
+template <typename T, std::size_t N = 0>
+using CountingExt =
+    CircularBufferExt<T, CountingAllocator<T>, NoBufferStats, N>;
+
+}  // namespace
+
+TEST(STORAGE_TEST, DEFAULT_CONSTRUCTION_DOES_NOT_ALLOCATE) {
+    allocations = 0;
+    CircularBuffer<std::string, CountingAllocator<std::string>> cb;
+    CountingExt<std::string> ext;
+    ASSERT_EQ(allocations, 0);
+    ASSERT_EQ(cb.capacity(), 0);
+    ASSERT_EQ(ext.capacity(), 0);
+
+    cb.push_back("dropped");
+    ASSERT_TRUE(cb.empty());
+    ext.push_back("kept");
+    ASSERT_EQ(allocations, 1);
+    ASSERT_EQ(ext.front(), "kept");
+}
+
+TEST(STORAGE_TEST, SMALL_BUFFER_SPILLS_ONLY_PAST_INLINE_CAPACITY) {
+    allocations = 0;
+    CountingExt<std::string, 4> cb;
+    ASSERT_EQ(cb.capacity(), 4);
+    for (int i = 0; i < 4; ++i) {
+        cb.push_back(std::to_string(i));
+    }
+    cb.pop_front();
+    cb.push_back("4");
+    ASSERT_EQ(allocations, 0);
+
+    cb.push_back("5");
+    ASSERT_EQ(allocations, 1);
+    ASSERT_EQ(cb.capacity(), 8);
+    ASSERT_EQ(cb.size(), 5);
+    for (int i = 0; i < 5; ++i) {
+        ASSERT_EQ(cb[i], std::to_string(i + 1));
+    }
+}
+
+TEST(STORAGE_TEST, SMALL_BUFFER_COPY_AND_SWAP) {
+    allocations = 0;
+    CountingExt<int, 4> small{1, 2, 3};
+    CountingExt<int, 4> copy(small);
+    ASSERT_EQ(allocations, 0);
+    ASSERT_EQ(copy, small);
+
+    CountingExt<int, 4> large{1, 2, 3, 4, 5, 6};
+    large.swap(small);
+    ASSERT_EQ(small.size(), 6);
+    ASSERT_EQ(small[5], 6);
+    ASSERT_EQ(large.size(), 3);
+    ASSERT_EQ(large[2], 3);
+
+    copy = large;
+    copy.push_back(4);
+    ASSERT_EQ(copy.back(), 4);
+}
+
+TEST(STORAGE_TEST, MOVE_STEALS_HEAP_STORAGE) {
+    CircularBuffer<std::string, CountingAllocator<std::string>> cb(3);
+    for (int i = 0; i < 5; ++i) {
+        cb.push_back(std::to_string(i));
+    }
+    const std::string* front = &cb.front();
+
+    allocations = 0;
+    auto moved(std::move(cb));
+    ASSERT_EQ(allocations, 0);
+    ASSERT_EQ(&moved.front(), front);
+    ASSERT_EQ(moved.size(), 3);
+    ASSERT_EQ(moved.back(), "4");
+    ASSERT_TRUE(cb.empty());
+    ASSERT_EQ(cb.capacity(), 0);
+
+    CircularBuffer<std::string, CountingAllocator<std::string>> other(8);
+    allocations = 0;
+    other = std::move(moved);
+    ASSERT_EQ(allocations, 0);
+    ASSERT_EQ(&other.front(), front);
+    ASSERT_EQ(other.capacity(), 3);
+    ASSERT_TRUE(moved.empty());
+}
+
+TEST(STORAGE_TEST, MOVE_OUT_OF_INLINE_STORAGE) {
+    CountingExt<std::string, 4> small{"a", "b", "c"};
+    CountingExt<std::string, 4> moved(std::move(small));
+    ASSERT_EQ(moved.size(), 3);
+    ASSERT_EQ(moved[2], "c");
+    ASSERT_TRUE(small.empty());
+
+    CountingExt<std::string, 4> large{"1", "2", "3", "4", "5"};
+    large = std::move(moved);
+    ASSERT_EQ(large.size(), 3);
+    ASSERT_EQ(large[0], "a");
+    small.push_back("d");
+    ASSERT_EQ(small.front(), "d");
+}
+
+TEST(STORAGE_TEST, SWAP_EXCHANGES_POINTERS) {
+    CircularBufferExt<int, CountingAllocator<int>> lhs{1, 2, 3};
+    CircularBufferExt<int, CountingAllocator<int>> rhs{4, 5};
+    const int* lhs_front = &lhs.front();
+
+    allocations = 0;
+    swap(lhs, rhs);
+    ASSERT_EQ(allocations, 0);
+    ASSERT_EQ(&rhs.front(), lhs_front);
+    ASSERT_EQ(lhs.size(), 2);
+    ASSERT_EQ(rhs.size(), 3);
+}
+
+TEST(STORAGE_TEST, VECTOR_OF_BUFFERS_MOVES_ON_GROWTH) {
+    static_assert(std::is_nothrow_move_constructible_v<CircularBuffer<int>>);
+    static_assert(
+        std::is_nothrow_move_constructible_v<CircularBufferExt<int>>);
+
+    std::vector<CircularBuffer<int, CountingAllocator<int>>> buffers;
+    buffers.reserve(1);
+    buffers.emplace_back(1024);
+    allocations = 0;
+    buffers.emplace_back(1024);
+    ASSERT_EQ(allocations, 1);
+}
+
+TEST(STORAGE_TEST, ASSIGNMENT_REUSES_STORAGE) {
+    CircularBuffer<std::string, CountingAllocator<std::string>> cb(4);
+    for (int i = 0; i < 6; ++i) {
+        cb.push_back(std::to_string(i));
+    }
+    const CircularBuffer<std::string, CountingAllocator<std::string>> state{
+        "a", "b", "c", "d"};
+
+    allocations = 0;
+    cb = state;
+    ASSERT_EQ(cb, state);
+    cb.assign(2, "x");
+    ASSERT_EQ(cb.size(), 2);
+    ASSERT_EQ(cb.back(), "x");
+    const std::vector<std::string> v = {"1", "2", "3"};
+    cb.assign(v.begin(), v.end());
+    ASSERT_EQ(allocations, 0);
+    ASSERT_EQ(cb.capacity(), 4);
+    ASSERT_EQ(cb.size(), 3);
+    ASSERT_EQ(cb.front(), "1");
+    ASSERT_EQ(cb.back(), "3");
+
+    cb.assign(5, "y");
+    ASSERT_EQ(allocations, 1);
+    ASSERT_EQ(cb.capacity(), 5);
+}
+
+TEST(STORAGE_TEST, TRIVIAL_FAST_PATHS_ON_WRAPPED_BUFFER) {
+    CircularBuffer<int> cb(5);
+    for (int i = 0; i < 8; ++i) {
+        cb.push_back(i);
+    }
+    ASSERT_FALSE(cb.second_segment().empty());
+
+    CircularBuffer<int> copy(cb);
+    ASSERT_EQ(copy, CircularBuffer<int>({3, 4, 5, 6, 7}));
+
+    cb.reserve(7);
+    ASSERT_EQ(cb, CircularBuffer<int>({3, 4, 5, 6, 7}));
+    ASSERT_TRUE(cb.second_segment().empty());
+
+    copy.resize(3);
+    ASSERT_EQ(copy, CircularBuffer<int>({3, 4, 5}));
+    copy.push_back(8);
+    ASSERT_EQ(copy.back(), 8);
+
+    copy.clear();
+    ASSERT_TRUE(copy.empty());
+    copy.push_back(9);
+    ASSERT_EQ(copy.front(), 9);
+
+    const std::vector<int> v = {1, 2, 3, 4, 5, 6, 7};
+    cb.assign(v.begin(), v.end());
+    ASSERT_EQ(cb, CircularBuffer<int>({1, 2, 3, 4, 5, 6, 7}));
+    CircularBuffer<int> from_range(v.begin(), v.end());
+    ASSERT_EQ(from_range, cb);
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+
+#include "lib/time_window_buffer.h"
+
+namespace {
+
+struct Event {
+    std::chrono::milliseconds ts;
+    std::string name;
+};
+
+}  // namespace
+
+TEST(TIME_WINDOW_TEST, EVICTS_ON_PUSH) {
+    TimeWindowBuffer<int> tw(5);
+    for (int ts : {1, 2, 4, 7, 8, 12}) {
+        tw.push(ts);
+    }
+
+    ASSERT_EQ(tw.size(), 3);
+    ASSERT_EQ(tw.front(), 7);
+    ASSERT_EQ(tw.back(), 12);
+}
+
+TEST(TIME_WINDOW_TEST, EXPIRE_WITHOUT_PUSH) {
+    TimeWindowBuffer<int> tw(5);
+    tw.push(1);
+    tw.push(3);
+    tw.expire(7);
+
+    ASSERT_EQ(tw.size(), 1);
+    ASSERT_EQ(tw.front(), 3);
+}
+
+TEST(TIME_WINDOW_TEST, OUT_OF_ORDER_PUSH) {
+    TimeWindowBuffer<int> tw(5);
+    tw.push(3);
+
+    try {
+        tw.push(2);
+        FAIL();
+    } catch (const std::invalid_argument& err) {
+        SUCCEED();
+    }
+}
+
+TEST(TIME_WINDOW_TEST, BOUNDS_BETWEEN_TIMESTAMPS) {
+    TimeWindowBuffer<int> tw(100);
+    for (int ts = 0; ts < 8; ++ts) {
+        tw.push(ts * 2);
+    }
+    ASSERT_EQ(*tw.lower_bound(5), 6);
+    ASSERT_EQ(*tw.upper_bound(6), 8);
+    ASSERT_TRUE(tw.lower_bound(15) == tw.end());
+    ASSERT_TRUE(tw.upper_bound(14) == tw.end());
+}
+
+TEST(TIME_WINDOW_TEST, BOUNDS_ACROSS_WRAP) {
+    // Expiring from the front while pushing at the back wraps the storage.
+    TimeWindowBuffer<int> wrapped(6);
+    for (int ts : {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 10, 11}) {
+        wrapped.push(ts);
+    }
+    ASSERT_FALSE(wrapped.buffer().second_segment().empty());
+
+    for (int ts = 0; ts <= 13; ++ts) {
+        auto lower = wrapped.lower_bound(ts);
+        auto upper = wrapped.upper_bound(ts);
+        auto expected_lower = wrapped.begin();
+        while (expected_lower != wrapped.end() && *expected_lower < ts) {
+            ++expected_lower;
+        }
+        auto expected_upper = expected_lower;
+        while (expected_upper != wrapped.end() && *expected_upper == ts) {
+            ++expected_upper;
+        }
+
+        ASSERT_TRUE(lower == expected_lower);
+        ASSERT_TRUE(upper == expected_upper);
+    }
+}
+
+TEST(TIME_WINDOW_TEST, PROJECTION_WITH_CHRONO) {
+    using namespace std::chrono_literals;
+    TimeWindowBuffer<Event, decltype(&Event::ts)> tw(5s, &Event::ts);
+    tw.push({1000ms, "open"});
+    tw.push({2500ms, "fill"});
+    tw.push({6500ms, "cancel"});
+    tw.push({7000ms, "close"});
+
+    ASSERT_EQ(tw.size(), 3);
+    ASSERT_EQ(tw.front().name, "fill");
+
+    auto [from, to] = tw.equal_range(6500ms);
+    ASSERT_EQ(from->name, "cancel");
+    ASSERT_EQ(to->name, "close");
+}
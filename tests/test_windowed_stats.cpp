@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include "lib/windowed_stats.h"
+
+TEST(WINDOWED_STATS_TEST, EMPTY_WINDOW) {
+    WindowedStats<double> stats(4);
+
+    ASSERT_TRUE(stats.empty());
+    ASSERT_EQ(stats.sum(), 0.0);
+    ASSERT_EQ(stats.variance(), 0.0);
+    try {
+        stats.min();
+        FAIL();
+    } catch (const std::out_of_range& err) {
+        SUCCEED();
+    }
+}
+
+TEST(WINDOWED_STATS_TEST, FILL_WITHOUT_OVERWRITE) {
+    WindowedStats<int> stats(4);
+    stats.push(3);
+    stats.push(-1);
+    stats.push(7);
+
+    ASSERT_EQ(stats.size(), 3);
+    ASSERT_EQ(stats.sum(), 9);
+    ASSERT_DOUBLE_EQ(stats.mean(), 3.0);
+    ASSERT_EQ(stats.min(), -1);
+    ASSERT_EQ(stats.max(), 7);
+}
+
+TEST(WINDOWED_STATS_TEST, OVERWRITE_RETIRES_OLDEST) {
+    WindowedStats<int> stats(3);
+    for (int value : {9, 1, 5, 2, 4}) {
+        stats.push(value);
+    }
+
+    ASSERT_TRUE(stats.window() == CircularBuffer<int>({5, 2, 4}));
+    ASSERT_EQ(stats.sum(), 11);
+    ASSERT_EQ(stats.min(), 2);
+    ASSERT_EQ(stats.max(), 5);
+}
+
+TEST(WINDOWED_STATS_TEST, MATCHES_FULL_RECOMPUTATION) {
+    const std::size_t window = 16;
+    WindowedStats<double> stats(window);
+    std::vector<double> history;
+
+    double x = 0.5;
+    for (int i = 0; i < 500; ++i) {
+        x = 3.9 * x * (1.0 - x);
+        const double value = 100.0 * x - 50.0;
+        stats.push(value);
+        history.push_back(value);
+
+        const std::size_t n = std::min(history.size(), window);
+        auto first = history.end() - n;
+        const double sum = std::accumulate(first, history.end(), 0.0);
+        const double mean = sum / n;
+        double m2 = 0.0;
+        for (auto it = first; it != history.end(); ++it) {
+            m2 += (*it - mean) * (*it - mean);
+        }
+
+        ASSERT_NEAR(stats.sum(), sum, 1e-9);
+        ASSERT_NEAR(stats.mean(), mean, 1e-9);
+        ASSERT_NEAR(stats.variance(), m2 / n, 1e-7);
+        ASSERT_EQ(stats.min(), *std::min_element(first, history.end()));
+        ASSERT_EQ(stats.max(), *std::max_element(first, history.end()));
+    }
+}
+
+TEST(WINDOWED_STATS_TEST, CLEAR) {
+    WindowedStats<int> stats(2);
+    stats.push(1);
+    stats.push(2);
+    stats.push(3);
+    stats.clear();
+    stats.push(10);
+
+    ASSERT_EQ(stats.size(), 1);
+    ASSERT_EQ(stats.sum(), 10);
+    ASSERT_EQ(stats.min(), 10);
+    ASSERT_EQ(stats.max(), 10);
+}
@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "lib/work_stealing_deque.h"
+
+TEST(WORK_STEALING_DEQUE_TEST, OWNER_POPS_LIFO_THIEF_STEALS_FIFO) {
+    WorkStealingDeque<int> deque(4);
+    for (int i = 0; i < 4; ++i) {
+        deque.push(i);
+    }
+    ASSERT_EQ(deque.size(), 4);
+    ASSERT_EQ(deque.pop(), 3);
+    ASSERT_EQ(deque.steal(), 0);
+    ASSERT_EQ(deque.pop(), 2);
+    ASSERT_EQ(deque.steal(), 1);
+    ASSERT_FALSE(deque.pop().has_value());
+    ASSERT_FALSE(deque.steal().has_value());
+    ASSERT_TRUE(deque.empty());
+}
+
+TEST(WORK_STEALING_DEQUE_TEST, GROWTH_KEEPS_ORDER) {
+    WorkStealingDeque<int> deque(3);
+    ASSERT_EQ(deque.capacity(), 4);
+    deque.push(-1);
+    ASSERT_EQ(deque.steal(), -1);
+    for (int i = 0; i < 100; ++i) {
+        deque.push(i);
+    }
+    ASSERT_EQ(deque.capacity(), 128);
+    for (int i = 0; i < 50; ++i) {
+        ASSERT_EQ(deque.steal(), i);
+    }
+    for (int i = 99; i >= 50; --i) {
+        ASSERT_EQ(deque.pop(), i);
+    }
+    ASSERT_TRUE(deque.empty());
+}
+
+TEST(WORK_STEALING_DEQUE_TEST, EVERY_ITEM_TAKEN_EXACTLY_ONCE) {
+    constexpr int kItems = 200000;
+    constexpr int kThieves = 3;
+    WorkStealingDeque<int> deque(2);
+    auto taken = std::make_unique<std::atomic<int>[]>(kItems);
+    std::atomic<int> total = 0;
+
+    std::thread thieves[kThieves];
+    for (auto& thief : thieves) {
+        thief = std::thread([&] {
+            while (total.load() < kItems) {
+                if (auto item = deque.steal()) {
+                    ++taken[*item];
+                    ++total;
+                }
+            }
+        });
+    }
+    for (int i = 0; i < kItems; ++i) {
+        deque.push(i);
+        if (i % 3 == 0) {
+            if (auto item = deque.pop()) {
+                ++taken[*item];
+                ++total;
+            }
+        }
+    }
+    while (auto item = deque.pop()) {
+        ++taken[*item];
+        ++total;
+    }
+    for (auto& thief : thieves) {
+        thief.join();
+    }
+
+    ASSERT_EQ(total.load(), kItems);
+    for (int i = 0; i < kItems; ++i) {
+        ASSERT_EQ(taken[i].load(), 1) << "item " << i;
+    }
+}